@@ -1,8 +1,23 @@
 #include "CMPlayerController.h"
 
+#include "CameraModes/Camera/CMSpringArmComponent.h"
+
 void ACMPlayerController::ProcessPlayerInput(const float DeltaTime, const bool bGamePaused)
 {
 	Super::ProcessPlayerInput(DeltaTime, bGamePaused);
 
 	OnRotationInputTickDelegate.Broadcast(RotationInput);
 }
+
+void ACMPlayerController::SetViewTarget(AActor* NewViewTarget, FViewTargetTransitionParams TransitionParams)
+{
+	const auto previousViewTarget = GetViewTarget();
+	
+	Super::SetViewTarget(NewViewTarget, TransitionParams);
+
+	if(previousViewTarget != GetViewTarget())
+	{
+		UCMSpringArmComponent::RefreshActivationOf(previousViewTarget);
+		UCMSpringArmComponent::RefreshActivationOf(GetViewTarget());
+	}
+}
@@ -12,6 +12,8 @@ class ACMPlayerController : public APlayerController
 	GENERATED_BODY()
 public:
 	virtual void ProcessPlayerInput(const float DeltaTime, const bool bGamePaused) override;
+
+	virtual void SetViewTarget(AActor* NewViewTarget, FViewTargetTransitionParams TransitionParams = FViewTargetTransitionParams()) override;
 	
 public:
 	FOnRotationInputTickDelegate OnRotationInputTickDelegate;
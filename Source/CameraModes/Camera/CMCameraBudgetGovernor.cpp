@@ -0,0 +1,129 @@
+#include "CMCameraBudgetGovernor.h"
+
+#include "CMCameraStats.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Camera frame cost (us)"), STAT_CMCameraFrameCost, STATGROUP_CameraModes);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Camera quality level"), STAT_CMCameraQualityLevel, STATGROUP_CameraModes);
+
+static TAutoConsoleVariable<float> CVarCameraBudgetFrameMicroseconds(
+	TEXT("CameraModes.Budget.FrameMicroseconds"),
+	0.f,
+	TEXT("Per frame budget of all camera spring arms in microseconds. Zero or less disables the governor."));
+
+static TAutoConsoleVariable<int32> CVarCameraBudgetStepDownFrames(
+	TEXT("CameraModes.Budget.StepDownFrames"),
+	5,
+	TEXT("Consecutive frames over budget before camera quality steps down."));
+
+static TAutoConsoleVariable<int32> CVarCameraBudgetStepUpFrames(
+	TEXT("CameraModes.Budget.StepUpFrames"),
+	60,
+	TEXT("Consecutive frames with headroom before camera quality steps up."));
+
+static TAutoConsoleVariable<float> CVarCameraBudgetStepUpHeadroom(
+	TEXT("CameraModes.Budget.StepUpHeadroom"),
+	0.6f,
+	TEXT("Fraction of the budget the frame cost has to stay under to count as headroom."));
+
+static TAutoConsoleVariable<int32> CVarCameraBudgetFadeTraceInterval(
+	TEXT("CameraModes.Budget.FadeTraceInterval"),
+	3,
+	TEXT("Frames between Fade traces from ReducedFadeRate quality level."));
+
+static TAutoConsoleVariable<int32> CVarCameraBudgetMaxOccluders(
+	TEXT("CameraModes.Budget.MaxOccluders"),
+	4,
+	TEXT("Occluders Fade tracks from ReducedOccluders quality level."));
+
+void UCMCameraBudgetGovernor::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	PostActorTickHandle = FWorldDelegates::OnWorldPostActorTick.AddUObject(this, &UCMCameraBudgetGovernor::OnWorldPostActorTick);
+}
+
+void UCMCameraBudgetGovernor::Deinitialize()
+{
+	FWorldDelegates::OnWorldPostActorTick.Remove(PostActorTickHandle);
+
+	Super::Deinitialize();
+}
+
+void UCMCameraBudgetGovernor::ReportArmCost(double Seconds)
+{
+	FrameCostSeconds += Seconds;
+}
+
+ECMCameraQualityLevel UCMCameraBudgetGovernor::GetQualityLevel() const
+{
+	return QualityLevel;
+}
+
+bool UCMCameraBudgetGovernor::IsQualityReduced(ECMCameraQualityLevel Level) const
+{
+	return QualityLevel >= Level;
+}
+
+int32 UCMCameraBudgetGovernor::GetFadeTraceInterval() const
+{
+	return IsQualityReduced(ECMCameraQualityLevel::ReducedFadeRate) ? FMath::Max(1, CVarCameraBudgetFadeTraceInterval.GetValueOnGameThread()) : 1;
+}
+
+int32 UCMCameraBudgetGovernor::GetMaxOccluders() const
+{
+	return IsQualityReduced(ECMCameraQualityLevel::ReducedOccluders) ? FMath::Max(1, CVarCameraBudgetMaxOccluders.GetValueOnGameThread()) : MAX_int32;
+}
+
+void UCMCameraBudgetGovernor::OnWorldPostActorTick(UWorld* World, ELevelTick TickType, float DeltaSeconds)
+{
+	if(World != GetWorld())
+	{
+		return;
+	}
+
+	const float frameCostMicroseconds = (float)(FrameCostSeconds * 1000000.0);
+	FrameCostSeconds = 0.0;
+
+	const auto previousQualityLevel = QualityLevel;
+
+	const float budgetMicroseconds = CVarCameraBudgetFrameMicroseconds.GetValueOnGameThread();
+	if(budgetMicroseconds <= 0.f)
+	{
+		QualityLevel = ECMCameraQualityLevel::Full;
+		FramesOverBudget = 0;
+		FramesWithHeadroom = 0;
+	}
+	else if(frameCostMicroseconds > budgetMicroseconds)
+	{
+		FramesWithHeadroom = 0;
+		if(++FramesOverBudget >= CVarCameraBudgetStepDownFrames.GetValueOnGameThread() && QualityLevel < ECMCameraQualityLevel::CachedProbes)
+		{
+			QualityLevel = (ECMCameraQualityLevel)((uint8)QualityLevel + 1);
+			FramesOverBudget = 0;
+		}
+	}
+	else if(frameCostMicroseconds < budgetMicroseconds * CVarCameraBudgetStepUpHeadroom.GetValueOnGameThread())
+	{
+		FramesOverBudget = 0;
+		if(++FramesWithHeadroom >= CVarCameraBudgetStepUpFrames.GetValueOnGameThread() && QualityLevel > ECMCameraQualityLevel::Full)
+		{
+			QualityLevel = (ECMCameraQualityLevel)((uint8)QualityLevel - 1);
+			FramesWithHeadroom = 0;
+		}
+	}
+	else
+	{
+		FramesOverBudget = 0;
+		FramesWithHeadroom = 0;
+	}
+
+	SET_FLOAT_STAT(STAT_CMCameraFrameCost, frameCostMicroseconds);
+	SET_DWORD_STAT(STAT_CMCameraQualityLevel, (uint32)QualityLevel);
+
+	if(QualityLevel != previousQualityLevel)
+	{
+		OnQualityLevelChanged.Broadcast(QualityLevel);
+	}
+}
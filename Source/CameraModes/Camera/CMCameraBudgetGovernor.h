@@ -0,0 +1,64 @@
+#pragma once
+
+#include "Subsystems/WorldSubsystem.h"
+
+#include "CMCameraBudgetGovernor.generated.h"
+
+/** Quality ladder of the camera pipeline, every level includes the reductions of the previous ones */
+UENUM(BlueprintType)
+enum class ECMCameraQualityLevel : uint8
+{
+	Full,
+	/** Fade traces run every FadeTraceInterval frames */
+	ReducedFadeRate,
+	/** Fade tracks at most MaxOccluders closest occluders */
+	ReducedOccluders,
+	/** Camera lag is evaluated in a single step */
+	NoLagSubstepping,
+	/** Collision probe result is reused on every other frame */
+	CachedProbes,
+};
+
+DECLARE_MULTICAST_DELEGATE_OneParam(FCMOnQualityLevelChanged, ECMCameraQualityLevel /*QualityLevel*/);
+
+/**
+ * Keeps the summed cost of all spring arms of a world inside CameraModes.Budget.FrameMicroseconds.
+ * Steps quality down after StepDownFrames frames over budget and back up after StepUpFrames frames with headroom.
+ */
+UCLASS()
+class UCMCameraBudgetGovernor : public UWorldSubsystem
+{
+	GENERATED_BODY()
+public:
+	// USubsystem interface
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	// End of USubsystem interface
+
+	void ReportArmCost(double Seconds);
+
+	UFUNCTION(BlueprintPure)
+	ECMCameraQualityLevel GetQualityLevel() const;
+
+	bool IsQualityReduced(ECMCameraQualityLevel Level) const;
+
+	int32 GetFadeTraceInterval() const;
+	int32 GetMaxOccluders() const;
+
+public:
+	/** Lets camera subsystems re-specialize on a quality step instead of checking the level every frame */
+	FCMOnQualityLevelChanged OnQualityLevelChanged;
+
+private:
+	void OnWorldPostActorTick(UWorld* World, ELevelTick TickType, float DeltaSeconds);
+
+private:
+	ECMCameraQualityLevel QualityLevel = ECMCameraQualityLevel::Full;
+
+	double FrameCostSeconds = 0.0;
+
+	int32 FramesOverBudget = 0;
+	int32 FramesWithHeadroom = 0;
+
+	FDelegateHandle PostActorTickHandle;
+};
@@ -0,0 +1,89 @@
+#include "CMCameraDebug.h"
+
+#include "Engine/World.h"
+
+#if CM_CAMERA_DEBUG
+int32 GCMCameraDebugFlags = 0;
+
+static FAutoConsoleVariableRef CVarCameraDebugFlags(
+	TEXT("CameraModes.Debug"),
+	GCMCameraDebugFlags,
+	TEXT("Camera modes debug drawing. Bit mask: 1 probes, 2 occluders, 4 lag targets, 8 camera modes."));
+#endif
+
+void FCMCameraDebugDrawer::DrawLine(const FVector& Start, const FVector& End, const FColor& Color, float Thickness)
+{
+	Lines.Emplace(Start, End, FLinearColor(Color), 0.f, Thickness, SDPG_World);
+}
+
+void FCMCameraDebugDrawer::DrawArrow(const FVector& Start, const FVector& End, float ArrowSize, const FColor& Color)
+{
+	DrawLine(Start, End, Color);
+
+	const FVector direction = (End - Start).GetSafeNormal();
+	if(direction.IsNearlyZero())
+	{
+		return;
+	}
+
+	const FVector side = FVector::CrossProduct(direction, FMath::Abs(direction.Z) < 0.99f ? FVector::UpVector : FVector::ForwardVector).GetSafeNormal();
+	DrawLine(End, End - direction * ArrowSize + side * ArrowSize * 0.5f, Color);
+	DrawLine(End, End - direction * ArrowSize - side * ArrowSize * 0.5f, Color);
+}
+
+void FCMCameraDebugDrawer::DrawSphere(const FVector& Center, float Radius, const FColor& Color)
+{
+	constexpr int32 numSegments = 12;
+
+	for(int32 segment = 0; segment < numSegments; ++segment)
+	{
+		float sin0, cos0, sin1, cos1;
+		FMath::SinCos(&sin0, &cos0, 2.f * PI * segment / numSegments);
+		FMath::SinCos(&sin1, &cos1, 2.f * PI * (segment + 1) / numSegments);
+
+		DrawLine(Center + FVector(cos0, sin0, 0.f) * Radius, Center + FVector(cos1, sin1, 0.f) * Radius, Color);
+		DrawLine(Center + FVector(cos0, 0.f, sin0) * Radius, Center + FVector(cos1, 0.f, sin1) * Radius, Color);
+		DrawLine(Center + FVector(0.f, cos0, sin0) * Radius, Center + FVector(0.f, cos1, sin1) * Radius, Color);
+	}
+}
+
+void FCMCameraDebugDrawer::DrawBox(const FVector& Center, const FVector& Extent, const FQuat& Rotation, const FColor& Color)
+{
+	FVector corners[8];
+	for(int32 cornerIndex = 0; cornerIndex < 8; ++cornerIndex)
+	{
+		const FVector corner((cornerIndex & 1) ? Extent.X : -Extent.X, (cornerIndex & 2) ? Extent.Y : -Extent.Y, (cornerIndex & 4) ? Extent.Z : -Extent.Z);
+		corners[cornerIndex] = Center + Rotation.RotateVector(corner);
+	}
+
+	for(int32 cornerIndex = 0; cornerIndex < 8; ++cornerIndex)
+	{
+		for(int32 axisBit = 1; axisBit < 8; axisBit <<= 1)
+		{
+			if((cornerIndex & axisBit) == 0)
+			{
+				DrawLine(corners[cornerIndex], corners[cornerIndex | axisBit], Color);
+			}
+		}
+	}
+}
+
+void FCMCameraDebugDrawer::DrawPoint(const FVector& Location, float Size, const FColor& Color)
+{
+	const float halfSize = Size * 0.5f;
+	DrawLine(Location - FVector(halfSize, 0.f, 0.f), Location + FVector(halfSize, 0.f, 0.f), Color);
+	DrawLine(Location - FVector(0.f, halfSize, 0.f), Location + FVector(0.f, halfSize, 0.f), Color);
+	DrawLine(Location - FVector(0.f, 0.f, halfSize), Location + FVector(0.f, 0.f, halfSize), Color);
+}
+
+void FCMCameraDebugDrawer::Flush(UWorld* World)
+{
+	if(Lines.Num() > 0)
+	{
+		if(World != nullptr && World->LineBatcher != nullptr)
+		{
+			World->LineBatcher->DrawLines(Lines);
+		}
+		Lines.Reset();
+	}
+}
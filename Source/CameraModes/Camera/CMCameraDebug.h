@@ -0,0 +1,51 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/LineBatchComponent.h"
+
+#define CM_CAMERA_DEBUG !(UE_BUILD_SHIPPING || UE_BUILD_TEST)
+
+class UWorld;
+
+enum class ECMCameraDebugFlags : int32
+{
+	None = 0,
+	Probes = 1 << 0,
+	Occluders = 1 << 1,
+	Lag = 1 << 2,
+	Modes = 1 << 3,
+};
+ENUM_CLASS_FLAGS(ECMCameraDebugFlags);
+
+#if CM_CAMERA_DEBUG
+/** Value of CameraModes.Debug */
+extern int32 GCMCameraDebugFlags;
+#endif
+
+/**
+ * Debug lines of one spring arm, submitted to the world line batcher in a single call at the end of the arm tick.
+ * Call sites are wrapped in CM_CAMERA_DEBUG and cost one branch on the console variable when it is off.
+ */
+class FCMCameraDebugDrawer
+{
+public:
+	static FORCEINLINE bool IsEnabled(ECMCameraDebugFlags Flags)
+	{
+#if CM_CAMERA_DEBUG
+		return (GCMCameraDebugFlags & (int32)Flags) != 0;
+#else
+		return false;
+#endif
+	}
+
+	void DrawLine(const FVector& Start, const FVector& End, const FColor& Color, float Thickness = 0.f);
+	void DrawArrow(const FVector& Start, const FVector& End, float ArrowSize, const FColor& Color);
+	void DrawSphere(const FVector& Center, float Radius, const FColor& Color);
+	void DrawBox(const FVector& Center, const FVector& Extent, const FQuat& Rotation, const FColor& Color);
+	void DrawPoint(const FVector& Location, float Size, const FColor& Color);
+
+	void Flush(UWorld* World);
+
+private:
+	TArray<FBatchedLine> Lines;
+};
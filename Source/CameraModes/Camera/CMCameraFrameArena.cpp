@@ -0,0 +1,109 @@
+#include "CMCameraFrameArena.h"
+
+DEFINE_STAT(STAT_CMFrameArrayHeapAllocations);
+
+namespace CMCameraFrameArena
+{
+	thread_local FCMCameraFrameArena* ActiveArena = nullptr;
+}
+
+FCMCameraFrameArena::FScope::FScope(FCMCameraFrameArena& Arena)
+	: PreviousArena(CMCameraFrameArena::ActiveArena)
+{
+	CMCameraFrameArena::ActiveArena = &Arena;
+}
+
+FCMCameraFrameArena::FScope::~FScope()
+{
+	CMCameraFrameArena::ActiveArena = PreviousArena;
+}
+
+FCMCameraFrameArena::FCMCameraFrameArena(SIZE_T InBlockSize)
+	: BlockSize(InBlockSize)
+{
+}
+
+FCMCameraFrameArena::~FCMCameraFrameArena()
+{
+	FreeBlocks();
+}
+
+void* FCMCameraFrameArena::Allocate(SIZE_T Size, uint32 Alignment)
+{
+	// Align(x, 0) is 0, every allocation would alias the start of the block
+	const uint32 alignment = FMath::Max(Alignment, MinAlignment);
+
+	while(CurrentBlock < Blocks.Num())
+	{
+		const auto& block = Blocks[CurrentBlock];
+		const SIZE_T alignedOffset = Align(CurrentOffset, alignment);
+		if(alignedOffset + Size <= block.Size)
+		{
+			CurrentOffset = alignedOffset + Size;
+			BytesUsed = BytesUsedInFullBlocks + CurrentOffset;
+			return block.Data + alignedOffset;
+		}
+
+		BytesUsedInFullBlocks += block.Size;
+		CurrentOffset = 0;
+		++CurrentBlock;
+	}
+
+	AddBlock(Size + alignment);
+	return Allocate(Size, alignment);
+}
+
+void FCMCameraFrameArena::Reset()
+{
+	// Frame did not fit in one block, replace them with a single block big enough for it
+	if(Blocks.Num() > 1)
+	{
+		SIZE_T totalSize = 0;
+		for(const auto& block : Blocks)
+		{
+			totalSize += block.Size;
+		}
+
+		FreeBlocks();
+		AddBlock(totalSize);
+	}
+
+	CurrentBlock = 0;
+	CurrentOffset = 0;
+	BytesUsed = 0;
+	BytesUsedInFullBlocks = 0;
+	NumBlockAllocations = 0;
+}
+
+int32 FCMCameraFrameArena::GetNumBlockAllocations() const
+{
+	return NumBlockAllocations;
+}
+
+SIZE_T FCMCameraFrameArena::GetBytesUsed() const
+{
+	return BytesUsed;
+}
+
+FCMCameraFrameArena* FCMCameraFrameArena::GetActive()
+{
+	return CMCameraFrameArena::ActiveArena;
+}
+
+void FCMCameraFrameArena::AddBlock(SIZE_T MinSize)
+{
+	auto& block = Blocks.AddDefaulted_GetRef();
+	block.Size = FMath::Max(BlockSize, MinSize);
+	block.Data = (uint8*)FMemory::Malloc(block.Size, MinAlignment);
+
+	++NumBlockAllocations;
+}
+
+void FCMCameraFrameArena::FreeBlocks()
+{
+	for(const auto& block : Blocks)
+	{
+		FMemory::Free(block.Data);
+	}
+	Blocks.Reset();
+}
@@ -0,0 +1,220 @@
+#pragma once
+
+#include "CMCameraStats.h"
+#include "CoreMinimal.h"
+
+/**
+ * Linear allocator for data that lives during a single camera tick.
+ * Owned by UCMSpringArmComponent and reset at the beginning of every arm tick.
+ * When a frame needs more than one block, the blocks are merged on the next reset so the steady state does no heap allocations.
+ */
+class FCMCameraFrameArena
+{
+public:
+	/** Makes the arena the target of TCMFrameArenaAllocator on this thread while in scope */
+	struct FScope
+	{
+	public:
+		explicit FScope(FCMCameraFrameArena& Arena);
+		~FScope();
+
+	private:
+		FCMCameraFrameArena* PreviousArena;
+	};
+
+public:
+	explicit FCMCameraFrameArena(SIZE_T InBlockSize = 16 * 1024);
+	~FCMCameraFrameArena();
+
+	FCMCameraFrameArena(const FCMCameraFrameArena&) = delete;
+	FCMCameraFrameArena& operator=(const FCMCameraFrameArena&) = delete;
+
+	/** Alignment is raised to MinAlignment, so DEFAULT_ALIGNMENT (0) still gets distinct, aligned memory */
+	void* Allocate(SIZE_T Size, uint32 Alignment);
+
+	void Reset();
+
+	/** Blocks the arena allocated since the last reset, other heap allocations made during the tick are not counted */
+	int32 GetNumBlockAllocations() const;
+	SIZE_T GetBytesUsed() const;
+
+	static FCMCameraFrameArena* GetActive();
+
+public:
+	/** Smallest alignment handed out, covers every vector register type stored in frame arrays */
+	static constexpr uint32 MinAlignment = 16;
+
+private:
+	struct FBlock
+	{
+	public:
+		uint8* Data = nullptr;
+		SIZE_T Size = 0;
+	};
+
+	void AddBlock(SIZE_T MinSize);
+	void FreeBlocks();
+
+private:
+	TArray<FBlock, TInlineAllocator<4>> Blocks;
+	int32 CurrentBlock = 0;
+	SIZE_T CurrentOffset = 0;
+
+	SIZE_T BlockSize;
+	SIZE_T BytesUsed = 0;
+	SIZE_T BytesUsedInFullBlocks = 0;
+	int32 NumBlockAllocations = 0;
+};
+
+/**
+ * TArray allocator taking its memory from the active FCMCameraFrameArena, or from the heap when there is none.
+ * Containers using it must not outlive the camera tick they were filled in.
+ */
+template<uint32 Alignment = DEFAULT_ALIGNMENT>
+class TCMFrameArenaAllocator
+{
+public:
+	using SizeType = int32;
+
+	enum { NeedsElementType = true };
+	enum { RequireRangeCheck = true };
+
+	class ForAnyElementType
+	{
+	public:
+		ForAnyElementType() = default;
+		ForAnyElementType(const ForAnyElementType&) = delete;
+		ForAnyElementType& operator=(const ForAnyElementType&) = delete;
+
+		~ForAnyElementType()
+		{
+			FreeHeapData();
+		}
+
+		FORCEINLINE void MoveToEmpty(ForAnyElementType& Other)
+		{
+			checkSlow(this != &Other);
+
+			FreeHeapData();
+
+			Data = Other.Data;
+			Arena = Other.Arena;
+			bHeapData = Other.bHeapData;
+
+			Other.Data = nullptr;
+			Other.bHeapData = false;
+		}
+
+		FORCEINLINE FScriptContainerElement* GetAllocation() const
+		{
+			return Data;
+		}
+
+		void ResizeAllocation(SizeType PreviousNumElements, SizeType NumElements, SIZE_T NumBytesPerElement)
+		{
+			FScriptContainerElement* oldData = Data;
+			const bool bOldHeapData = bHeapData;
+
+			Data = nullptr;
+			bHeapData = false;
+
+			if(NumElements > 0)
+			{
+				if(Arena == nullptr)
+				{
+					Arena = FCMCameraFrameArena::GetActive();
+				}
+
+				const SIZE_T numBytes = NumElements * NumBytesPerElement;
+				if(Arena != nullptr)
+				{
+					Data = (FScriptContainerElement*)Arena->Allocate(numBytes, Alignment);
+				}
+				else
+				{
+					Data = (FScriptContainerElement*)FMemory::Malloc(numBytes, Alignment);
+					bHeapData = true;
+
+					INC_DWORD_STAT(STAT_CMFrameArrayHeapAllocations);
+				}
+
+				if(oldData != nullptr && PreviousNumElements > 0)
+				{
+					FMemory::Memcpy(Data, oldData, FMath::Min(PreviousNumElements, NumElements) * NumBytesPerElement);
+				}
+			}
+
+			if(bOldHeapData)
+			{
+				FMemory::Free(oldData);
+			}
+		}
+
+		FORCEINLINE SizeType CalculateSlackReserve(SizeType NumElements, SIZE_T NumBytesPerElement) const
+		{
+			return DefaultCalculateSlackReserve(NumElements, NumBytesPerElement, false, Alignment);
+		}
+
+		FORCEINLINE SizeType CalculateSlackShrink(SizeType NumElements, SizeType NumAllocatedElements, SIZE_T NumBytesPerElement) const
+		{
+			return DefaultCalculateSlackShrink(NumElements, NumAllocatedElements, NumBytesPerElement, false, Alignment);
+		}
+
+		FORCEINLINE SizeType CalculateSlackGrow(SizeType NumElements, SizeType NumAllocatedElements, SIZE_T NumBytesPerElement) const
+		{
+			return DefaultCalculateSlackGrow(NumElements, NumAllocatedElements, NumBytesPerElement, false, Alignment);
+		}
+
+		SIZE_T GetAllocatedSize(SizeType NumAllocatedElements, SIZE_T NumBytesPerElement) const
+		{
+			return NumAllocatedElements * NumBytesPerElement;
+		}
+
+		bool HasAllocation() const
+		{
+			return Data != nullptr;
+		}
+
+		SizeType GetInitialCapacity() const
+		{
+			return 0;
+		}
+
+	private:
+		void FreeHeapData()
+		{
+			if(bHeapData)
+			{
+				FMemory::Free(Data);
+				Data = nullptr;
+				bHeapData = false;
+			}
+		}
+
+	private:
+		FScriptContainerElement* Data = nullptr;
+		FCMCameraFrameArena* Arena = nullptr;
+		bool bHeapData = false;
+	};
+
+	template<typename ElementType>
+	class ForElementType : public ForAnyElementType
+	{
+	public:
+		ForElementType() = default;
+
+		FORCEINLINE ElementType* GetAllocation() const
+		{
+			return (ElementType*)ForAnyElementType::GetAllocation();
+		}
+	};
+};
+
+template<uint32 Alignment>
+struct TAllocatorTraits<TCMFrameArenaAllocator<Alignment>> : TAllocatorTraitsBase<TCMFrameArenaAllocator<Alignment>>
+{
+	enum { SupportsMove = true };
+};
+
+template<typename ElementType>
+using TCMFrameArray = TArray<ElementType, TCMFrameArenaAllocator<>>;
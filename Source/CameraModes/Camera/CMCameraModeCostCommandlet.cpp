@@ -0,0 +1,88 @@
+#include "CMCameraModeCostCommandlet.h"
+
+#include "CMCameraMode.h"
+#include "AssetRegistryModule.h"
+#include "CameraSubsystems/CMCameraSubsystem.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+UCMCameraModeCostCommandlet::UCMCameraModeCostCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = true;
+	LogToConsole = true;
+}
+
+int32 UCMCameraModeCostCommandlet::Main(const FString& Params)
+{
+	float budgetMicroseconds = 50.f;
+	FParse::Value(*Params, TEXT("BudgetMicroseconds="), budgetMicroseconds);
+
+	FCMCameraCostContext costContext;
+	FParse::Value(*Params, TEXT("WorstFrameTime="), costContext.WorstFrameTime);
+	FParse::Value(*Params, TEXT("ExpectedOccluders="), costContext.ExpectedOccluders);
+	FParse::Value(*Params, TEXT("MeshesPerOccluder="), costContext.MeshesPerOccluder);
+
+	auto& assetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>("AssetRegistry").Get();
+	assetRegistry.SearchAllAssets(true);
+
+	TArray<FAssetData> cameraModeAssets;
+	assetRegistry.GetAssetsByClass(UCMCameraMode::StaticClass()->GetFName(), cameraModeAssets, true);
+
+	FString csv = TEXT("Asset,CameraModeTag,SceneQueries,QueryShapes,MaxLagIterations,MaterialWrites,OutputWrites,AllocationRisk,EstimatedMicroseconds,OverBudget\n");
+	int32 numOverBudget = 0;
+
+	for(const auto& cameraModeAsset : cameraModeAssets)
+	{
+		const auto cameraMode = Cast<UCMCameraMode>(cameraModeAsset.GetAsset());
+		if(cameraMode == nullptr)
+		{
+			continue;
+		}
+
+		FCMCameraSubsystemCost cost;
+		for(const auto subsystem : cameraMode->CameraSubsystems)
+		{
+			if(subsystem != nullptr && subsystem->GetSubsystemSettings() != nullptr)
+			{
+				subsystem->EstimateCost(costContext, cost);
+			}
+		}
+
+		const float estimatedMicroseconds = cost.NumSceneQueries * SceneQueryMicroseconds
+			+ cost.MaxLagIterations * LagIterationMicroseconds
+			+ cost.NumMaterialWrites * MaterialWriteMicroseconds
+			+ cost.NumOutputWrites * OutputWriteMicroseconds;
+
+		const bool bOverBudget = estimatedMicroseconds > budgetMicroseconds;
+		if(bOverBudget)
+		{
+			++numOverBudget;
+			UE_LOG(LogTemp, Warning, TEXT("Camera mode %s is over budget: %.1f us estimated, %.1f us allowed (%d queries, %d lag iterations, %d material writes)"),
+				*cameraModeAsset.ObjectPath.ToString(), estimatedMicroseconds, budgetMicroseconds, cost.NumSceneQueries, cost.MaxLagIterations, cost.NumMaterialWrites);
+		}
+
+		csv += FString::Printf(TEXT("%s,%s,%d,%s,%d,%d,%d,%s,%.1f,%s\n"),
+			*cameraModeAsset.ObjectPath.ToString(),
+			*cameraMode->CameraModeTag.ToString(),
+			cost.NumSceneQueries,
+			*FString::Join(cost.SceneQueryShapes, TEXT(" | ")),
+			cost.MaxLagIterations,
+			cost.NumMaterialWrites,
+			cost.NumOutputWrites,
+			cost.bAllocationRisk ? TEXT("Yes") : TEXT("No"),
+			estimatedMicroseconds,
+			bOverBudget ? TEXT("Yes") : TEXT("No"));
+	}
+
+	const FString csvPath = FPaths::ProjectSavedDir() / TEXT("CameraModeCost.csv");
+	if(!FFileHelper::SaveStringToFile(csv, *csvPath))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Failed to write camera mode cost report to %s"), *csvPath);
+		return 2;
+	}
+
+	UE_LOG(LogTemp, Display, TEXT("Camera mode cost report for %d modes written to %s, %d over budget"), cameraModeAssets.Num(), *csvPath, numOverBudget);
+	return numOverBudget > 0 ? 1 : 0;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "Commandlets/Commandlet.h"
+
+#include "CMCameraModeCostCommandlet.generated.h"
+
+/**
+ * Estimates the per frame cost of every UCMCameraMode asset from its subsystem settings and writes Saved/CameraModeCost.csv.
+ * Modes over budget are logged as warnings and make the commandlet return 1, so content checks can fail on them.
+ *
+ * UE4Editor-Cmd CameraModes -run=CMCameraModeCost [-BudgetMicroseconds=50] [-WorstFrameTime=0.1] [-ExpectedOccluders=4] [-MeshesPerOccluder=4]
+ */
+UCLASS()
+class UCMCameraModeCostCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+public:
+	UCMCameraModeCostCommandlet();
+
+	// UCommandlet interface
+	virtual int32 Main(const FString& Params) override;
+	// End of UCommandlet interface
+
+public:
+	/** Rough game thread costs the estimate is weighted with, tune them against profiles of the target hardware */
+	static constexpr float SceneQueryMicroseconds = 15.f;
+	static constexpr float LagIterationMicroseconds = 0.5f;
+	static constexpr float MaterialWriteMicroseconds = 1.f;
+	static constexpr float OutputWriteMicroseconds = 0.1f;
+};
@@ -0,0 +1,108 @@
+#include "CMCameraModeRules.h"
+
+void FCMCameraModeRuleSet::Compile(const TArray<FCMCameraModeRule>& Rules)
+{
+	CompiledRules.Reset();
+	ReferencedTags.Reset();
+	OwnedTagMasks.Reset();
+
+	auto sortedRules = Rules;
+	sortedRules.StableSort([](const FCMCameraModeRule& A, const FCMCameraModeRule& B)
+	{
+		return A.Priority > B.Priority;
+	});
+
+	for(const auto& rule : sortedRules)
+	{
+		for(const auto& tag : rule.RequiredTags)
+		{
+			ReferencedTags.AddUnique(tag);
+		}
+		for(const auto& tag : rule.BlockedTags)
+		{
+			ReferencedTags.AddUnique(tag);
+		}
+	}
+
+	if(ReferencedTags.Num() > MaxReferencedTags)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Camera mode rules reference %d tags, only %d are supported! Rules using the rest never match."), ReferencedTags.Num(), MaxReferencedTags);
+	}
+
+	for(const auto& rule : sortedRules)
+	{
+		auto& compiledRule = CompiledRules.AddDefaulted_GetRef();
+		compiledRule.RequiredMask = GetReferencedTagsMask(rule.RequiredTags);
+		compiledRule.BlockedMask = GetReferencedTagsMask(rule.BlockedTags);
+		compiledRule.CameraModeTag = rule.CameraModeTag;
+
+		// Required tag without a bit can never be owned
+		for(const auto& tag : rule.RequiredTags)
+		{
+			if(ReferencedTags.IndexOfByKey(tag) >= MaxReferencedTags)
+			{
+				compiledRule.RequiredMask = MAX_uint64;
+				break;
+			}
+		}
+	}
+}
+
+bool FCMCameraModeRuleSet::IsEmpty() const
+{
+	return CompiledRules.Num() == 0;
+}
+
+FGameplayTag FCMCameraModeRuleSet::Evaluate(const FGameplayTagContainer& OwnedTags)
+{
+	uint64 ownedMask = 0;
+	for(const auto& ownedTag : OwnedTags)
+	{
+		ownedMask |= GetOwnedTagMask(ownedTag);
+	}
+
+	for(const auto& compiledRule : CompiledRules)
+	{
+		if((ownedMask & compiledRule.RequiredMask) == compiledRule.RequiredMask && (ownedMask & compiledRule.BlockedMask) == 0)
+		{
+			return compiledRule.CameraModeTag;
+		}
+	}
+
+	return FGameplayTag();
+}
+
+uint64 FCMCameraModeRuleSet::GetReferencedTagsMask(const FGameplayTagContainer& Tags)
+{
+	uint64 mask = 0;
+	for(const auto& tag : Tags)
+	{
+		const int32 bitIndex = ReferencedTags.IndexOfByKey(tag);
+		if(bitIndex != INDEX_NONE && bitIndex < MaxReferencedTags)
+		{
+			mask |= 1ull << bitIndex;
+		}
+	}
+	return mask;
+}
+
+uint64 FCMCameraModeRuleSet::GetOwnedTagMask(const FGameplayTag& OwnedTag)
+{
+	if(const auto cachedMask = OwnedTagMasks.Find(OwnedTag))
+	{
+		return *cachedMask;
+	}
+
+	uint64 mask = 0;
+	const int32 numBits = FMath::Min(ReferencedTags.Num(), MaxReferencedTags);
+	for(int32 bitIndex = 0; bitIndex < numBits; ++bitIndex)
+	{
+		if(OwnedTag.MatchesTag(ReferencedTags[bitIndex]))
+		{
+			mask |= 1ull << bitIndex;
+		}
+	}
+
+	OwnedTagMasks.Add(OwnedTag, mask);
+	return mask;
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "GameplayTagContainer.h"
+
+#include "CMCameraModeRules.generated.h"
+
+USTRUCT(BlueprintType)
+struct FCMCameraModeRule
+{
+	GENERATED_BODY()
+public:
+	/** Owner has to have all of these tags */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FGameplayTagContainer RequiredTags;
+
+	/** Owner must not have any of these tags */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FGameplayTagContainer BlockedTags;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FGameplayTag CameraModeTag;
+
+	/** Highest priority matching rule wins */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int32 Priority = 0;
+};
+
+/**
+ * Camera mode rules compiled into bit masks over the tags they reference.
+ * Owned tags are converted to the same bits once per tag, so evaluation is a few mask tests.
+ */
+class FCMCameraModeRuleSet
+{
+public:
+	void Compile(const TArray<FCMCameraModeRule>& Rules);
+
+	bool IsEmpty() const;
+
+	/** Returns the camera mode tag of the highest priority rule matching OwnedTags, or an invalid tag */
+	FGameplayTag Evaluate(const FGameplayTagContainer& OwnedTags);
+
+public:
+	static constexpr int32 MaxReferencedTags = 64;
+
+private:
+	uint64 GetReferencedTagsMask(const FGameplayTagContainer& Tags);
+	uint64 GetOwnedTagMask(const FGameplayTag& OwnedTag);
+
+private:
+	struct FCompiledRule
+	{
+	public:
+		uint64 RequiredMask = 0;
+		uint64 BlockedMask = 0;
+		FGameplayTag CameraModeTag;
+	};
+
+	TArray<FCompiledRule> CompiledRules;
+	TArray<FGameplayTag> ReferencedTags;
+
+	/** Bits of the referenced tags each owned tag matches, including its parents */
+	TMap<FGameplayTag, uint64> OwnedTagMasks;
+};
@@ -0,0 +1,51 @@
+#include "CMCameraModeVolume.h"
+
+#include "CMCameraModeVolumeIndex.h"
+#include "Components/BoxComponent.h"
+#include "Engine/World.h"
+
+ACMCameraModeVolume::ACMCameraModeVolume()
+{
+	PrimaryActorTick.bCanEverTick = false;
+
+	BoxComponent = CreateDefaultSubobject<UBoxComponent>("Box");
+	BoxComponent->SetCollisionProfileName(UCollisionProfile::NoCollision_ProfileName);
+	BoxComponent->SetGenerateOverlapEvents(false);
+	BoxComponent->SetBoxExtent(FVector(500.f));
+	BoxComponent->SetHiddenInGame(true);
+	RootComponent = BoxComponent;
+}
+
+void ACMCameraModeVolume::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if(const auto volumeIndex = GetWorld()->GetSubsystem<UCMCameraModeVolumeIndex>())
+	{
+		volumeIndex->RegisterVolume(this);
+	}
+}
+
+void ACMCameraModeVolume::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if(const auto volumeIndex = GetWorld()->GetSubsystem<UCMCameraModeVolumeIndex>())
+	{
+		volumeIndex->UnregisterVolume(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+bool ACMCameraModeVolume::ContainsPoint(const FVector& Point) const
+{
+	const FVector localPoint = BoxComponent->GetComponentTransform().InverseTransformPosition(Point);
+	const FVector boxExtent = BoxComponent->GetUnscaledBoxExtent();
+
+	return FMath::Abs(localPoint.X) <= boxExtent.X && FMath::Abs(localPoint.Y) <= boxExtent.Y && FMath::Abs(localPoint.Z) <= boxExtent.Z;
+}
+
+FBox ACMCameraModeVolume::GetVolumeBounds() const
+{
+	const FVector boxExtent = BoxComponent->GetUnscaledBoxExtent();
+	return FBox(-boxExtent, boxExtent).TransformBy(BoxComponent->GetComponentTransform());
+}
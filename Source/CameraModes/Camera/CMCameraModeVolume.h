@@ -0,0 +1,42 @@
+#pragma once
+
+#include "GameplayTagContainer.h"
+#include "GameFramework/Actor.h"
+
+#include "CMCameraModeVolume.generated.h"
+
+class UBoxComponent;
+
+/**
+ * Area that overrides the camera mode of spring arms whose origin is inside it.
+ * Containment is tested by UCMSpringArmComponent against the world's UCMCameraModeVolumeIndex,
+ * the box has no collision and generates no overlaps.
+ */
+UCLASS()
+class ACMCameraModeVolume : public AActor
+{
+	GENERATED_BODY()
+public:
+	ACMCameraModeVolume();
+
+	// AActor interface
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	// End of AActor interface
+
+	bool ContainsPoint(const FVector& Point) const;
+
+	FBox GetVolumeBounds() const;
+
+public:
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Camera Modes")
+	FGameplayTag CameraModeTag;
+
+	/** The volume with the highest priority wins where volumes intersect */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Camera Modes")
+	int32 Priority = 0;
+
+private:
+	UPROPERTY(VisibleAnywhere)
+	UBoxComponent* BoxComponent;
+};
@@ -0,0 +1,84 @@
+#include "CMCameraModeVolumeIndex.h"
+
+#include "CMCameraModeVolume.h"
+
+void UCMCameraModeVolumeIndex::RegisterVolume(ACMCameraModeVolume* Volume)
+{
+	if(Volume == nullptr || IndexedBounds.Contains(Volume))
+	{
+		return;
+	}
+
+	const FBox bounds = Volume->GetVolumeBounds();
+	IndexedBounds.Add(Volume, bounds);
+	AddToCells(Volume, bounds);
+
+	++Version;
+}
+
+void UCMCameraModeVolumeIndex::UnregisterVolume(ACMCameraModeVolume* Volume)
+{
+	FBox bounds;
+	if(!IndexedBounds.RemoveAndCopyValue(Volume, bounds))
+	{
+		return;
+	}
+
+	if(Grid.GetOversizedCell().RemoveSingleSwap(Volume, false) == 0)
+	{
+		Grid.ForEachCellCoord(Grid.GetCellCoord(bounds.Min), Grid.GetCellCoord(bounds.Max), [this, Volume](const FIntVector& CellCoord)
+		{
+			if(const auto cell = Grid.FindCell(CellCoord))
+			{
+				cell->RemoveSingleSwap(Volume, false);
+				if(cell->Num() == 0)
+				{
+					Grid.RemoveCell(CellCoord);
+				}
+			}
+		});
+	}
+
+	++Version;
+}
+
+void UCMCameraModeVolumeIndex::GetCandidates(const FIntVector& Cell, TArray<TWeakObjectPtr<ACMCameraModeVolume>>& OutCandidates) const
+{
+	if(const auto cell = Grid.FindCell(Cell))
+	{
+		OutCandidates.Append(*cell);
+	}
+	OutCandidates.Append(Grid.GetOversizedCell());
+}
+
+FIntVector UCMCameraModeVolumeIndex::GetCellCoord(const FVector& Location) const
+{
+	return Grid.GetCellCoord(Location);
+}
+
+uint32 UCMCameraModeVolumeIndex::GetVersion() const
+{
+	return Version;
+}
+
+bool UCMCameraModeVolumeIndex::IsEmpty() const
+{
+	return IndexedBounds.Num() == 0;
+}
+
+void UCMCameraModeVolumeIndex::AddToCells(ACMCameraModeVolume* Volume, const FBox& Bounds)
+{
+	const FIntVector minCell = Grid.GetCellCoord(Bounds.Min);
+	const FIntVector maxCell = Grid.GetCellCoord(Bounds.Max);
+
+	if(Grid.IsOversized(minCell, maxCell))
+	{
+		Grid.GetOversizedCell().Add(Volume);
+		return;
+	}
+
+	Grid.ForEachCellCoord(minCell, maxCell, [this, Volume](const FIntVector& CellCoord)
+	{
+		Grid.FindOrAddCell(CellCoord).Add(Volume);
+	});
+}
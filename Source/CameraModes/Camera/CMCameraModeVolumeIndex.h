@@ -0,0 +1,47 @@
+#pragma once
+
+#include "CMUniformGrid.h"
+#include "Subsystems/WorldSubsystem.h"
+
+#include "CMCameraModeVolumeIndex.generated.h"
+
+class ACMCameraModeVolume;
+
+/**
+ * Per-world uniform grid of camera mode volumes, filled as volumes begin play.
+ * Spring arms fetch the candidates of their cell only when they cross a cell boundary or the index changes.
+ */
+UCLASS()
+class UCMCameraModeVolumeIndex : public UWorldSubsystem
+{
+	GENERATED_BODY()
+public:
+	void RegisterVolume(ACMCameraModeVolume* Volume);
+	void UnregisterVolume(ACMCameraModeVolume* Volume);
+
+	/** Appends volumes whose bounds touch Cell */
+	void GetCandidates(const FIntVector& Cell, TArray<TWeakObjectPtr<ACMCameraModeVolume>>& OutCandidates) const;
+
+	FIntVector GetCellCoord(const FVector& Location) const;
+
+	/** Changes every time a volume is added or removed */
+	uint32 GetVersion() const;
+
+	bool IsEmpty() const;
+
+public:
+	/** Volumes spanning more than MaxCellsPerVolume cells are kept in the oversized cell every query returns */
+	static constexpr float CellSize = 2000.f;
+	static constexpr int32 MaxCellsPerVolume = 256;
+
+private:
+	void AddToCells(ACMCameraModeVolume* Volume, const FBox& Bounds);
+
+private:
+	TCMUniformGrid<TArray<TWeakObjectPtr<ACMCameraModeVolume>>> Grid = TCMUniformGrid<TArray<TWeakObjectPtr<ACMCameraModeVolume>>>(CellSize, MaxCellsPerVolume);
+
+	/** Bounds the volume was indexed with, used to remove it from the same cells */
+	TMap<TWeakObjectPtr<ACMCameraModeVolume>, FBox> IndexedBounds;
+
+	uint32 Version = 0;
+};
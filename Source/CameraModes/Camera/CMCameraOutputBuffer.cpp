@@ -0,0 +1,137 @@
+#include "CMCameraOutputBuffer.h"
+
+#include "CMCameraStats.h"
+#include "Camera/PlayerCameraManager.h"
+#include "GameFramework/PlayerController.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Camera output writes applied"), STAT_CMCameraOutputWritesApplied, STATGROUP_CameraModes);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Camera output writes skipped"), STAT_CMCameraOutputWritesSkipped, STATGROUP_CameraModes);
+
+void FCMCameraOutputBuffer::SetFOV(float NewFOV)
+{
+	FOV = NewFOV;
+	MarkPending(ECMCameraOutput::FOV);
+}
+
+void FCMCameraOutputBuffer::SetViewPitchMin(float NewViewPitchMin)
+{
+	ViewPitchMin = NewViewPitchMin;
+	MarkPending(ECMCameraOutput::ViewPitchMin);
+}
+
+void FCMCameraOutputBuffer::SetViewPitchMax(float NewViewPitchMax)
+{
+	ViewPitchMax = NewViewPitchMax;
+	MarkPending(ECMCameraOutput::ViewPitchMax);
+}
+
+void FCMCameraOutputBuffer::SetControlRotation(const FRotator& NewControlRotation)
+{
+	ControlRotation = NewControlRotation;
+	MarkPending(ECMCameraOutput::ControlRotation);
+}
+
+bool FCMCameraOutputBuffer::GetPendingFOV(float& OutFOV) const
+{
+	if(IsPending(ECMCameraOutput::FOV))
+	{
+		OutFOV = FOV;
+		return true;
+	}
+	return false;
+}
+
+bool FCMCameraOutputBuffer::GetPendingViewPitchMin(float& OutViewPitchMin) const
+{
+	if(IsPending(ECMCameraOutput::ViewPitchMin))
+	{
+		OutViewPitchMin = ViewPitchMin;
+		return true;
+	}
+	return false;
+}
+
+bool FCMCameraOutputBuffer::GetPendingViewPitchMax(float& OutViewPitchMax) const
+{
+	if(IsPending(ECMCameraOutput::ViewPitchMax))
+	{
+		OutViewPitchMax = ViewPitchMax;
+		return true;
+	}
+	return false;
+}
+
+bool FCMCameraOutputBuffer::GetPendingControlRotation(FRotator& OutControlRotation) const
+{
+	if(IsPending(ECMCameraOutput::ControlRotation))
+	{
+		OutControlRotation = ControlRotation;
+		return true;
+	}
+	return false;
+}
+
+bool FCMCameraOutputBuffer::IsPending(ECMCameraOutput Output) const
+{
+	return (PendingMask & (1 << (uint8)Output)) != 0;
+}
+
+void FCMCameraOutputBuffer::Apply(APlayerController* Controller, APlayerCameraManager* CameraManager)
+{
+	int32 numApplied = 0;
+	int32 numSkipped = 0;
+
+	auto applyIfChanged = [&numApplied, &numSkipped](bool bChanged, TFunctionRef<void()> Write)
+	{
+		if(bChanged)
+		{
+			Write();
+			++numApplied;
+		}
+		else
+		{
+			++numSkipped;
+		}
+	};
+
+	if(CameraManager != nullptr)
+	{
+		if(IsPending(ECMCameraOutput::FOV))
+		{
+			applyIfChanged(CameraManager->GetFOVAngle() != FOV, [this, CameraManager]() { CameraManager->SetFOV(FOV); });
+		}
+
+		if(IsPending(ECMCameraOutput::ViewPitchMin))
+		{
+			applyIfChanged(CameraManager->ViewPitchMin != ViewPitchMin, [this, CameraManager]() { CameraManager->ViewPitchMin = ViewPitchMin; });
+		}
+
+		if(IsPending(ECMCameraOutput::ViewPitchMax))
+		{
+			applyIfChanged(CameraManager->ViewPitchMax != ViewPitchMax, [this, CameraManager]() { CameraManager->ViewPitchMax = ViewPitchMax; });
+		}
+	}
+
+	if(Controller != nullptr)
+	{
+		if(IsPending(ECMCameraOutput::ControlRotation))
+		{
+			applyIfChanged(Controller->GetControlRotation() != ControlRotation, [this, Controller]() { Controller->SetControlRotation(ControlRotation); });
+		}
+	}
+
+	INC_DWORD_STAT_BY(STAT_CMCameraOutputWritesApplied, numApplied);
+	INC_DWORD_STAT_BY(STAT_CMCameraOutputWritesSkipped, numSkipped);
+
+	Reset();
+}
+
+void FCMCameraOutputBuffer::Reset()
+{
+	PendingMask = 0;
+}
+
+void FCMCameraOutputBuffer::MarkPending(ECMCameraOutput Output)
+{
+	PendingMask |= 1 << (uint8)Output;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+class APlayerController;
+class APlayerCameraManager;
+
+enum class ECMCameraOutput : uint8
+{
+	FOV,
+	ViewPitchMin,
+	ViewPitchMax,
+	ControlRotation,
+};
+
+/**
+ * Writes camera subsystems make to the camera manager and the controller.
+ * Every output keeps only its last value, and the spring arm applies them once at the end of its tick,
+ * skipping the ones that would not change anything.
+ */
+class FCMCameraOutputBuffer
+{
+public:
+	void SetFOV(float NewFOV);
+	void SetViewPitchMin(float NewViewPitchMin);
+	void SetViewPitchMax(float NewViewPitchMax);
+	void SetControlRotation(const FRotator& NewControlRotation);
+
+	bool GetPendingFOV(float& OutFOV) const;
+	bool GetPendingViewPitchMin(float& OutViewPitchMin) const;
+	bool GetPendingViewPitchMax(float& OutViewPitchMax) const;
+	bool GetPendingControlRotation(FRotator& OutControlRotation) const;
+
+	bool IsPending(ECMCameraOutput Output) const;
+
+	/** Applies pending writes and clears the buffer */
+	void Apply(APlayerController* Controller, APlayerCameraManager* CameraManager);
+	void Reset();
+
+private:
+	void MarkPending(ECMCameraOutput Output);
+
+private:
+	uint8 PendingMask = 0;
+
+	float FOV = 0.f;
+	float ViewPitchMin = 0.f;
+	float ViewPitchMax = 0.f;
+	FRotator ControlRotation = FRotator::ZeroRotator;
+};
@@ -0,0 +1,221 @@
+#include "CMCameraPoseHistory.h"
+
+#include "CMCameraStats.h"
+
+DECLARE_CYCLE_STAT(TEXT("Pose history encode"), STAT_CMPoseHistoryEncode, STATGROUP_CameraModes);
+DECLARE_MEMORY_STAT(TEXT("Pose history memory"), STAT_CMPoseHistoryMemory, STATGROUP_CameraModes);
+
+namespace CMCameraPoseHistory
+{
+	constexpr float MaxFOV = 180.f;
+	constexpr float MaxBlockSpan = MAX_uint16 / 1000.f;
+}
+
+FCMCameraPoseHistory::~FCMCameraPoseHistory()
+{
+	DEC_MEMORY_STAT_BY(STAT_CMPoseHistoryMemory, Blocks.GetAllocatedSize());
+}
+
+void FCMCameraPoseHistory::Configure(float Duration, float SampleRate)
+{
+	DEC_MEMORY_STAT_BY(STAT_CMPoseHistoryMemory, Blocks.GetAllocatedSize());
+
+	const int32 numSamples = FMath::Max(1, FMath::CeilToInt(Duration * SampleRate));
+	// One spare block, the newest block is usually partially filled
+	const int32 numBlocks = FMath::DivideAndRoundUp(numSamples, SamplesPerBlock) + 1;
+
+	Blocks.Empty(numBlocks);
+	Blocks.SetNum(numBlocks);
+	MinSampleInterval = SampleRate > 0.f ? 1.f / SampleRate : 0.f;
+
+	INC_MEMORY_STAT_BY(STAT_CMPoseHistoryMemory, Blocks.GetAllocatedSize());
+
+	Reset();
+}
+
+void FCMCameraPoseHistory::Reset()
+{
+	NewestBlock = INDEX_NONE;
+	NumUsedBlocks = 0;
+	LastRecordTime = -MAX_flt;
+	CameraModeTags.Reset();
+}
+
+void FCMCameraPoseHistory::Record(float Time, const FCMCameraPose& Pose)
+{
+	SCOPE_CYCLE_COUNTER(STAT_CMPoseHistoryEncode);
+
+	if(Blocks.Num() == 0 || Time < LastRecordTime + MinSampleInterval)
+	{
+		return;
+	}
+	LastRecordTime = Time;
+
+	FSample sample;
+	if(NewestBlock != INDEX_NONE)
+	{
+		auto& block = Blocks[NewestBlock];
+		if(block.NumSamples < SamplesPerBlock && TryEncode(block, Time, Pose, sample))
+		{
+			block.Samples[block.NumSamples++] = sample;
+			return;
+		}
+	}
+
+	// Block is full or the pose moved out of its delta range, start a new key and drop the oldest block
+	NewestBlock = (NewestBlock + 1) % Blocks.Num();
+	NumUsedBlocks = FMath::Min(NumUsedBlocks + 1, Blocks.Num());
+
+	auto& block = Blocks[NewestBlock];
+	block.KeyLocation = Pose.Location;
+	block.KeyTime = Time;
+	block.NumSamples = 0;
+
+	verify(TryEncode(block, Time, Pose, sample));
+	block.Samples[block.NumSamples++] = sample;
+}
+
+bool FCMCameraPoseHistory::SamplePose(float Time, FCMCameraPose& OutPose) const
+{
+	if(IsEmpty())
+	{
+		return false;
+	}
+
+	// Newest block whose key is not after Time
+	int32 low = 0;
+	int32 high = NumUsedBlocks - 1;
+	while(low < high)
+	{
+		const int32 middle = (low + high + 1) / 2;
+		if(GetBlock(middle).KeyTime <= Time)
+		{
+			low = middle;
+		}
+		else
+		{
+			high = middle - 1;
+		}
+	}
+
+	const auto& block = GetBlock(low);
+
+	int32 sampleIndex = 0;
+	while(sampleIndex + 1 < block.NumSamples && GetSampleTime(block, sampleIndex + 1) <= Time)
+	{
+		++sampleIndex;
+	}
+
+	Decode(block, block.Samples[sampleIndex], OutPose);
+
+	const float sampleTime = GetSampleTime(block, sampleIndex);
+	if(Time <= sampleTime)
+	{
+		return true;
+	}
+
+	const FBlock* nextBlock = &block;
+	int32 nextSampleIndex = sampleIndex + 1;
+	if(nextSampleIndex >= block.NumSamples)
+	{
+		if(low + 1 >= NumUsedBlocks)
+		{
+			return true;
+		}
+		nextBlock = &GetBlock(low + 1);
+		nextSampleIndex = 0;
+	}
+
+	FCMCameraPose nextPose;
+	Decode(*nextBlock, nextBlock->Samples[nextSampleIndex], nextPose);
+
+	const float nextSampleTime = GetSampleTime(*nextBlock, nextSampleIndex);
+	const float alpha = nextSampleTime > sampleTime ? FMath::Clamp((Time - sampleTime) / (nextSampleTime - sampleTime), 0.f, 1.f) : 1.f;
+
+	OutPose.Location = FMath::Lerp(OutPose.Location, nextPose.Location, alpha);
+	OutPose.Rotation = FQuat::Slerp(OutPose.Rotation.Quaternion(), nextPose.Rotation.Quaternion(), alpha).Rotator();
+	OutPose.FOV = FMath::Lerp(OutPose.FOV, nextPose.FOV, alpha);
+	return true;
+}
+
+bool FCMCameraPoseHistory::IsEmpty() const
+{
+	return NumUsedBlocks == 0;
+}
+
+float FCMCameraPoseHistory::GetOldestTime() const
+{
+	return IsEmpty() ? 0.f : GetBlock(0).KeyTime;
+}
+
+float FCMCameraPoseHistory::GetNewestTime() const
+{
+	if(IsEmpty())
+	{
+		return 0.f;
+	}
+	const auto& block = Blocks[NewestBlock];
+	return GetSampleTime(block, block.NumSamples - 1);
+}
+
+SIZE_T FCMCameraPoseHistory::GetAllocatedSize() const
+{
+	return Blocks.GetAllocatedSize() + CameraModeTags.GetAllocatedSize();
+}
+
+bool FCMCameraPoseHistory::TryEncode(const FBlock& Block, float Time, const FCMCameraPose& Pose, FSample& OutSample)
+{
+	const FVector delta = (Pose.Location - Block.KeyLocation) / LocationQuantum;
+	if(delta.GetAbsMax() > MAX_int16 || Time - Block.KeyTime > CMCameraPoseHistory::MaxBlockSpan)
+	{
+		return false;
+	}
+
+	OutSample.DeltaX = (int16)FMath::RoundToInt(delta.X);
+	OutSample.DeltaY = (int16)FMath::RoundToInt(delta.Y);
+	OutSample.DeltaZ = (int16)FMath::RoundToInt(delta.Z);
+	OutSample.Pitch = FRotator::CompressAxisToShort(Pose.Rotation.Pitch);
+	OutSample.Yaw = FRotator::CompressAxisToShort(Pose.Rotation.Yaw);
+	OutSample.Roll = FRotator::CompressAxisToShort(Pose.Rotation.Roll);
+	OutSample.FOV = (uint16)FMath::RoundToInt(FMath::Clamp(Pose.FOV / CMCameraPoseHistory::MaxFOV, 0.f, 1.f) * MAX_uint16);
+	OutSample.DeltaTime = (uint16)FMath::RoundToInt((Time - Block.KeyTime) * 1000.f);
+	OutSample.CameraModeIndex = GetCameraModeIndex(Pose.CameraModeTag);
+	return true;
+}
+
+void FCMCameraPoseHistory::Decode(const FBlock& Block, const FSample& Sample, FCMCameraPose& OutPose) const
+{
+	OutPose.Location = Block.KeyLocation + FVector(Sample.DeltaX, Sample.DeltaY, Sample.DeltaZ) * LocationQuantum;
+	OutPose.Rotation.Pitch = FRotator::DecompressAxisFromShort(Sample.Pitch);
+	OutPose.Rotation.Yaw = FRotator::DecompressAxisFromShort(Sample.Yaw);
+	OutPose.Rotation.Roll = FRotator::DecompressAxisFromShort(Sample.Roll);
+	OutPose.FOV = Sample.FOV * CMCameraPoseHistory::MaxFOV / MAX_uint16;
+	OutPose.CameraModeTag = CameraModeTags.IsValidIndex(Sample.CameraModeIndex) ? CameraModeTags[Sample.CameraModeIndex] : FGameplayTag();
+}
+
+float FCMCameraPoseHistory::GetSampleTime(const FBlock& Block, int32 SampleIndex) const
+{
+	return Block.KeyTime + Block.Samples[SampleIndex].DeltaTime / 1000.f;
+}
+
+const FCMCameraPoseHistory::FBlock& FCMCameraPoseHistory::GetBlock(int32 Age) const
+{
+	const int32 oldestBlock = NewestBlock - NumUsedBlocks + 1;
+	return Blocks[(oldestBlock + Age + Blocks.Num()) % Blocks.Num()];
+}
+
+uint8 FCMCameraPoseHistory::GetCameraModeIndex(const FGameplayTag& CameraModeTag)
+{
+	int32 index = CameraModeTags.Find(CameraModeTag);
+	if(index == INDEX_NONE)
+	{
+		// Projects have a handful of modes, past the index range the last slot is reused
+		if(CameraModeTags.Num() > MAX_uint8)
+		{
+			CameraModeTags[MAX_uint8] = CameraModeTag;
+			return MAX_uint8;
+		}
+		index = CameraModeTags.Add(CameraModeTag);
+	}
+	return (uint8)index;
+}
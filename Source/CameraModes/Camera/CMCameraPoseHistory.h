@@ -0,0 +1,95 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameplayTagContainer.h"
+
+struct FCMCameraPose
+{
+public:
+	FVector Location = FVector::ZeroVector;
+	FRotator Rotation = FRotator::ZeroRotator;
+	float FOV = 90.f;
+	FGameplayTag CameraModeTag;
+};
+
+/**
+ * Fixed memory ring buffer of recent camera poses for kill-cams and rewinds.
+ * Poses are stored in blocks of SamplesPerBlock: every block keeps a full precision key location and time,
+ * samples only keep quantized deltas to it, so any sample is decoded without walking the block.
+ */
+class FCMCameraPoseHistory
+{
+public:
+	FCMCameraPoseHistory() = default;
+	~FCMCameraPoseHistory();
+
+	FCMCameraPoseHistory(const FCMCameraPoseHistory&) = delete;
+	FCMCameraPoseHistory& operator=(const FCMCameraPoseHistory&) = delete;
+
+	/** Allocates room for Duration seconds at SampleRate samples per second and clears the history */
+	void Configure(float Duration, float SampleRate);
+	void Reset();
+
+	/** Records the pose, poses closer than the sample interval to the previous one are dropped */
+	void Record(float Time, const FCMCameraPose& Pose);
+
+	/** Interpolates the pose at Time, clamped to the recorded range. False when nothing was recorded. */
+	bool SamplePose(float Time, FCMCameraPose& OutPose) const;
+
+	bool IsEmpty() const;
+	float GetOldestTime() const;
+	float GetNewestTime() const;
+
+	SIZE_T GetAllocatedSize() const;
+
+public:
+	static constexpr int32 SamplesPerBlock = 16;
+
+	/** Size of one location step, deltas to the block key are stored in int16 so a block spans about +-40m */
+	static constexpr float LocationQuantum = 0.125f;
+
+private:
+	struct FSample
+	{
+	public:
+		int16 DeltaX = 0;
+		int16 DeltaY = 0;
+		int16 DeltaZ = 0;
+		uint16 Pitch = 0;
+		uint16 Yaw = 0;
+		uint16 Roll = 0;
+		uint16 FOV = 0;
+		/** Milliseconds since the block key time */
+		uint16 DeltaTime = 0;
+		uint8 CameraModeIndex = 0;
+	};
+
+	struct FBlock
+	{
+	public:
+		FVector KeyLocation = FVector::ZeroVector;
+		float KeyTime = 0.f;
+		int32 NumSamples = 0;
+		FSample Samples[SamplesPerBlock];
+	};
+
+	bool TryEncode(const FBlock& Block, float Time, const FCMCameraPose& Pose, FSample& OutSample);
+	void Decode(const FBlock& Block, const FSample& Sample, FCMCameraPose& OutPose) const;
+	float GetSampleTime(const FBlock& Block, int32 SampleIndex) const;
+
+	/** Block by age, 0 is the oldest */
+	const FBlock& GetBlock(int32 Age) const;
+
+	uint8 GetCameraModeIndex(const FGameplayTag& CameraModeTag);
+
+private:
+	TArray<FBlock> Blocks;
+	int32 NewestBlock = INDEX_NONE;
+	int32 NumUsedBlocks = 0;
+
+	float MinSampleInterval = 0.f;
+	float LastRecordTime = -MAX_flt;
+
+	/** Tags referenced by the samples, a sample only keeps the index */
+	TArray<FGameplayTag> CameraModeTags;
+};
@@ -0,0 +1,371 @@
+#include "CMCameraQueryBroker.h"
+
+#include "CMCameraStats.h"
+#include "CollisionQueryParams.h"
+#include "WorldCollision.h"
+#include "Components/PrimitiveComponent.h"
+#include "Engine/World.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Scene queries issued"), STAT_CMSceneQueriesIssued, STATGROUP_CameraModes);
+
+int32 FCMCameraQueryBroker::SetQuery(int32 Handle, const FCMCameraSceneQuery& Query)
+{
+	if(Queries.IsValidIndex(Handle))
+	{
+		Queries[Handle] = Query;
+		return Handle;
+	}
+	return Queries.Add(Query);
+}
+
+void FCMCameraQueryBroker::RemoveQuery(int32 Handle)
+{
+	if(Queries.IsValidIndex(Handle))
+	{
+		Queries.RemoveAt(Handle);
+		LastSegments.Remove(Handle);
+	}
+}
+
+void FCMCameraQueryBroker::BeginFrame(UWorld* InWorld, const AActor* InOwner)
+{
+	World = InWorld;
+	Owner = InOwner;
+
+	bMergedValid = false;
+	bMergeSkipped = false;
+	MergedCandidates.Reset();
+	MergedCandidateSet.Reset();
+}
+
+void FCMCameraQueryBroker::Resolve(int32 Handle, const FVector& Start, const FVector& End, const FQuat& Rotation, TArray<FHitResult>& OutHits)
+{
+	OutHits.Reset();
+
+	if(!Queries.IsValidIndex(Handle) || World == nullptr)
+	{
+		return;
+	}
+
+	const auto& query = Queries[Handle];
+	LastSegments.Add(Handle, TPair<FVector, FVector>(Start, End));
+
+	// Merging only pays off when somebody else is going to reuse the candidates
+	if(Queries.Num() > 1)
+	{
+		if(!bMergedValid && !bMergeSkipped)
+		{
+			if(ShouldMerge(Handle, Start, End))
+			{
+				ExecuteMerged(Start, End);
+			}
+			else
+			{
+				bMergeSkipped = true;
+			}
+		}
+
+		if(IsInsideMerged(query, Start, End))
+		{
+			ResolveFromCandidates(query, MergedCandidates, Start, End, Rotation, OutHits);
+			return;
+		}
+	}
+
+	ResolveDirect(query, Start, End, Rotation, OutHits);
+}
+
+bool FCMCameraQueryBroker::ResolveSingle(int32 Handle, const FVector& Start, const FVector& End, const FQuat& Rotation, FHitResult& OutHit)
+{
+	Resolve(Handle, Start, End, Rotation, SingleHits);
+
+	OutHit = SingleHits.Num() > 0 ? SingleHits[0] : FHitResult();
+	return OutHit.bBlockingHit;
+}
+
+void FCMCameraQueryBroker::ResolveFan(int32 Handle, const FVector& Start, TArrayView<const FVector> Ends, const FQuat& Rotation, TArray<FHitResult>& OutHits)
+{
+	if(Ends.Num() <= 1)
+	{
+		if(Ends.Num() == 1)
+		{
+			Resolve(Handle, Start, Ends[0], Rotation, OutHits);
+		}
+		else
+		{
+			OutHits.Reset();
+		}
+		return;
+	}
+
+	OutHits.Reset();
+
+	if(!Queries.IsValidIndex(Handle) || World == nullptr)
+	{
+		return;
+	}
+
+	const auto& query = Queries[Handle];
+
+	// Fans never read the merged candidates, a stale single segment would keep other queries merging for nobody
+	LastSegments.Remove(Handle);
+
+	FBox fanBounds(Start, Start);
+	for(const auto& end : Ends)
+	{
+		fanBounds += end;
+	}
+	const float shapeRadius = GetShapeRadius(query.Shape);
+	fanBounds = fanBounds.ExpandBy(shapeRadius);
+
+	if(fanBounds.GetExtent().GetMax() > MaxFanExtent)
+	{
+		for(const auto& end : Ends)
+		{
+			FanSegmentHits.Reset();
+			ResolveDirect(query, Start, end, Rotation, FanSegmentHits);
+			OutHits.Append(FanSegmentHits);
+		}
+		return;
+	}
+
+	FCollisionQueryParams queryParams(SCENE_QUERY_STAT(CMCameraQueryBrokerFan), false, query.bIgnoreOwner ? Owner : nullptr);
+
+	FanOverlaps.Reset();
+	World->OverlapMultiByChannel(FanOverlaps, fanBounds.GetCenter(), FQuat::Identity, query.Channel, FCollisionShape::MakeBox(fanBounds.GetExtent()), queryParams);
+	INC_DWORD_STAT(STAT_CMSceneQueriesIssued);
+
+	FanCandidates.Reset();
+	FanCandidateBounds.Reset();
+	FanCandidateSet.Reset();
+	for(const auto& overlap : FanOverlaps)
+	{
+		const auto component = overlap.GetComponent();
+		bool bAlreadyCandidate = false;
+		if(component != nullptr)
+		{
+			FanCandidateSet.Add(component, &bAlreadyCandidate);
+			if(!bAlreadyCandidate)
+			{
+				FanCandidates.Add(component);
+				FanCandidateBounds.Add(component->Bounds.GetBox());
+			}
+		}
+	}
+
+	for(const auto& end : Ends)
+	{
+		// Only candidates the segment's swept shape can reach get a narrow phase sweep
+		const FBox segmentBounds = FBox(Start.ComponentMin(end), Start.ComponentMax(end)).ExpandBy(shapeRadius);
+		FanSegmentCandidates.Reset();
+		for(int32 index = 0; index < FanCandidates.Num(); ++index)
+		{
+			if(segmentBounds.Intersect(FanCandidateBounds[index]))
+			{
+				FanSegmentCandidates.Add(FanCandidates[index]);
+			}
+		}
+
+		FanSegmentHits.Reset();
+		ResolveFromCandidates(query, FanSegmentCandidates, Start, end, Rotation, FanSegmentHits);
+		OutHits.Append(FanSegmentHits);
+	}
+
+	FanCandidates.Reset();
+	FanCandidateSet.Reset();
+}
+
+bool FCMCameraQueryBroker::ShouldMerge(int32 Handle, const FVector& Start, const FVector& End) const
+{
+	const float mergedRadius = GetMergedRadius();
+	for(const auto& lastSegment : LastSegments)
+	{
+		if(lastSegment.Key != Handle && Queries.IsValidIndex(lastSegment.Key)
+			&& IsSegmentInside(lastSegment.Value.Key, lastSegment.Value.Value, Start, End, mergedRadius - GetShapeRadius(Queries[lastSegment.Key].Shape)))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void FCMCameraQueryBroker::ExecuteMerged(const FVector& Start, const FVector& End)
+{
+	MergedRadius = GetMergedRadius();
+
+	// Overlaps do not stop at the first blocking hit, so every query can be answered from the candidates.
+	// Queries sharing a channel overlap through it, mixed channels take one overlap of every object type and
+	// ResolveFromCandidates filters by each query's channel response, either way the segment is traced once.
+	ECollisionChannel channel = ECollisionChannel::ECC_MAX;
+	bool bSingleChannel = true;
+	bool bIgnoreOwner = true;
+	for(const auto& query : Queries)
+	{
+		channel = channel == ECollisionChannel::ECC_MAX ? query.Channel : channel;
+		bSingleChannel &= query.Channel == channel;
+		bIgnoreOwner &= query.bIgnoreOwner;
+	}
+
+	FCollisionQueryParams queryParams(SCENE_QUERY_STAT(CMCameraQueryBrokerMerged), false, bIgnoreOwner ? Owner : nullptr);
+
+	// Capsule around the segment, the same volume the sphere sweep of MergedRadius covers
+	const FVector segment = End - Start;
+	const float halfLength = segment.Size() * 0.5f;
+	const FQuat capsuleRotation = halfLength > KINDA_SMALL_NUMBER ? FRotationMatrix::MakeFromZ(segment).ToQuat() : FQuat::Identity;
+	const FCollisionShape capsule = FCollisionShape::MakeCapsule(MergedRadius, halfLength + MergedRadius);
+
+	MergedOverlaps.Reset();
+	if(bSingleChannel)
+	{
+		World->OverlapMultiByChannel(MergedOverlaps, (Start + End) * 0.5f, capsuleRotation, channel, capsule, queryParams);
+	}
+	else
+	{
+		World->OverlapMultiByObjectType(MergedOverlaps, (Start + End) * 0.5f, capsuleRotation, FCollisionObjectQueryParams(FCollisionObjectQueryParams::AllObjects), capsule, queryParams);
+	}
+	INC_DWORD_STAT(STAT_CMSceneQueriesIssued);
+
+	for(const auto& overlap : MergedOverlaps)
+	{
+		const auto component = overlap.GetComponent();
+		bool bAlreadyCandidate = false;
+		if(component != nullptr)
+		{
+			MergedCandidateSet.Add(component, &bAlreadyCandidate);
+			if(!bAlreadyCandidate)
+			{
+				MergedCandidates.Add(component);
+			}
+		}
+	}
+
+	MergedStart = Start;
+	MergedEnd = End;
+	bMergedValid = true;
+}
+
+bool FCMCameraQueryBroker::IsInsideMerged(const FCMCameraSceneQuery& Query, const FVector& Start, const FVector& End) const
+{
+	return bMergedValid && IsSegmentInside(Start, End, MergedStart, MergedEnd, MergedRadius - GetShapeRadius(Query.Shape));
+}
+
+float FCMCameraQueryBroker::GetMergedRadius() const
+{
+	float mergedRadius = MergeMargin;
+	for(const auto& query : Queries)
+	{
+		mergedRadius = FMath::Max(mergedRadius, GetShapeRadius(query.Shape) + MergeMargin);
+	}
+	return mergedRadius;
+}
+
+bool FCMCameraQueryBroker::IsSegmentInside(const FVector& Start, const FVector& End, const FVector& OuterStart, const FVector& OuterEnd, float AllowedDistance)
+{
+	if(AllowedDistance < 0.f)
+	{
+		return false;
+	}
+
+	// The merged volume is convex, both ends inside means the whole swept shape is inside
+	return FMath::PointDistToSegmentSquared(Start, OuterStart, OuterEnd) <= FMath::Square(AllowedDistance)
+		&& FMath::PointDistToSegmentSquared(End, OuterStart, OuterEnd) <= FMath::Square(AllowedDistance);
+}
+
+void FCMCameraQueryBroker::ResolveFromCandidates(const FCMCameraSceneQuery& Query, const TArray<UPrimitiveComponent*>& Candidates, const FVector& Start, const FVector& End, const FQuat& Rotation, TArray<FHitResult>& OutHits) const
+{
+	for(const auto component : Candidates)
+	{
+		if(component == nullptr || !component->IsQueryCollisionEnabled())
+		{
+			continue;
+		}
+
+		if(Query.bIgnoreOwner && component->GetOwner() == Owner)
+		{
+			continue;
+		}
+
+		const ECollisionResponse response = component->GetCollisionResponseToChannel(Query.Channel);
+		if(response == ECollisionResponse::ECR_Ignore)
+		{
+			continue;
+		}
+
+		FHitResult hit;
+		if(component->SweepComponent(hit, Start, End, Rotation, Query.Shape))
+		{
+			hit.bBlockingHit = response == ECollisionResponse::ECR_Block;
+			OutHits.Add(hit);
+		}
+	}
+
+	OutHits.Sort([](const FHitResult& A, const FHitResult& B)
+	{
+		return A.Time < B.Time;
+	});
+
+	const int32 firstBlockingIndex = OutHits.IndexOfByPredicate([](const FHitResult& Hit)
+	{
+		return Hit.bBlockingHit;
+	});
+
+	if(!Query.bMultiHit)
+	{
+		if(firstBlockingIndex == INDEX_NONE)
+		{
+			OutHits.Reset();
+		}
+		else
+		{
+			const FHitResult blockingHit = OutHits[firstBlockingIndex];
+			OutHits.Reset();
+			OutHits.Add(blockingHit);
+		}
+	}
+	else if(firstBlockingIndex != INDEX_NONE)
+	{
+		OutHits.SetNum(firstBlockingIndex + 1, false);
+	}
+}
+
+void FCMCameraQueryBroker::ResolveDirect(const FCMCameraSceneQuery& Query, const FVector& Start, const FVector& End, const FQuat& Rotation, TArray<FHitResult>& OutHits)
+{
+	FCollisionQueryParams queryParams(SCENE_QUERY_STAT(CMCameraQueryBroker), false, Query.bIgnoreOwner ? Owner : nullptr);
+
+	if(Query.bMultiHit)
+	{
+		World->SweepMultiByChannel(OutHits, Start, End, Rotation, Query.Channel, Query.Shape, queryParams);
+	}
+	else
+	{
+		FHitResult hit;
+		if(World->SweepSingleByChannel(hit, Start, End, Rotation, Query.Channel, Query.Shape, queryParams))
+		{
+			OutHits.Add(hit);
+		}
+	}
+	INC_DWORD_STAT(STAT_CMSceneQueriesIssued);
+}
+
+float FCMCameraQueryBroker::GetShapeRadius(const FCollisionShape& Shape)
+{
+	switch(Shape.ShapeType)
+	{
+		case ECollisionShape::Sphere:
+		{
+			return Shape.GetSphereRadius();
+		}
+		case ECollisionShape::Box:
+		{
+			return Shape.GetExtent().Size();
+		}
+		case ECollisionShape::Capsule:
+		{
+			return Shape.GetCapsuleHalfHeight();
+		}
+		default:
+		{
+			return 0.f;
+		}
+	}
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CollisionShape.h"
+#include "Engine/EngineTypes.h"
+#include "WorldCollision.h"
+
+class AActor;
+class UPrimitiveComponent;
+class UWorld;
+
+struct FCMCameraSceneQuery
+{
+public:
+	ECollisionChannel Channel = ECollisionChannel::ECC_Visibility;
+	FCollisionShape Shape;
+	/** Multi queries return touches up to and including the first blocking hit, single queries only the first blocking hit */
+	bool bMultiHit = false;
+	bool bIgnoreOwner = true;
+};
+
+/**
+ * Collects the scene queries camera subsystems run every frame.
+ * When the segments other queries resolved last frame lie around the first query resolved in a frame, it issues one overlap
+ * around its segment; later queries whose segment lies inside only run narrow phase tests against its candidates.
+ */
+class FCMCameraQueryBroker
+{
+public:
+	/** Adds the query when Handle is INDEX_NONE, updates it otherwise. Returns the handle to resolve with. */
+	int32 SetQuery(int32 Handle, const FCMCameraSceneQuery& Query);
+	void RemoveQuery(int32 Handle);
+
+	void BeginFrame(UWorld* InWorld, const AActor* InOwner);
+
+	void Resolve(int32 Handle, const FVector& Start, const FVector& End, const FQuat& Rotation, TArray<FHitResult>& OutHits);
+	bool ResolveSingle(int32 Handle, const FVector& Start, const FVector& End, const FQuat& Rotation, FHitResult& OutHit);
+
+	/**
+	 * Resolves the query from Start to every End, e.g. from the camera to several focus targets.
+	 * One overlap around the whole fan collects the candidates, every segment then only runs narrow phase tests against the ones
+	 * its swept bounds touch. Fans wider than MaxFanExtent sweep every segment on its own instead.
+	 * Hits of all segments are appended to OutHits, each segment sorted and cut like Resolve.
+	 */
+	void ResolveFan(int32 Handle, const FVector& Start, TArrayView<const FVector> Ends, const FQuat& Rotation, TArray<FHitResult>& OutHits);
+
+public:
+	/** Extra radius of the merged overlap, lets segments that do not exactly match the first resolved one reuse it */
+	float MergeMargin = 100.f;
+
+	/** Largest half extent of a fan resolved with one overlap, a wider box collects more candidates than the separate sweeps test */
+	float MaxFanExtent = 1500.f;
+
+private:
+	/** True when another query resolved last frame inside the merged overlap Start to End would build */
+	bool ShouldMerge(int32 Handle, const FVector& Start, const FVector& End) const;
+	void ExecuteMerged(const FVector& Start, const FVector& End);
+	bool IsInsideMerged(const FCMCameraSceneQuery& Query, const FVector& Start, const FVector& End) const;
+	float GetMergedRadius() const;
+
+	static bool IsSegmentInside(const FVector& Start, const FVector& End, const FVector& OuterStart, const FVector& OuterEnd, float AllowedDistance);
+	void ResolveFromCandidates(const FCMCameraSceneQuery& Query, const TArray<UPrimitiveComponent*>& Candidates, const FVector& Start, const FVector& End, const FQuat& Rotation, TArray<FHitResult>& OutHits) const;
+	void ResolveDirect(const FCMCameraSceneQuery& Query, const FVector& Start, const FVector& End, const FQuat& Rotation, TArray<FHitResult>& OutHits);
+
+	static float GetShapeRadius(const FCollisionShape& Shape);
+
+private:
+	TSparseArray<FCMCameraSceneQuery> Queries;
+
+	UWorld* World = nullptr;
+	const AActor* Owner = nullptr;
+
+	/** Segment every query resolved last, decides whether merging will be reused */
+	TMap<int32, TPair<FVector, FVector>> LastSegments;
+
+	bool bMergedValid = false;
+	/** The first query of the frame found nobody to share with */
+	bool bMergeSkipped = false;
+	FVector MergedStart = FVector::ZeroVector;
+	FVector MergedEnd = FVector::ZeroVector;
+	float MergedRadius = 0.f;
+	TArray<UPrimitiveComponent*> MergedCandidates;
+	TSet<UPrimitiveComponent*> MergedCandidateSet;
+	TArray<FOverlapResult> MergedOverlaps;
+
+	/** Candidates of the last fan and their bounds, only valid inside ResolveFan */
+	TArray<UPrimitiveComponent*> FanCandidates;
+	TArray<FBox> FanCandidateBounds;
+	TSet<UPrimitiveComponent*> FanCandidateSet;
+	TArray<UPrimitiveComponent*> FanSegmentCandidates;
+	TArray<FOverlapResult> FanOverlaps;
+	TArray<FHitResult> FanSegmentHits;
+
+	/** Scratch hit array kept between frames, scene queries only accept default allocated arrays */
+	TArray<FHitResult> SingleHits;
+};
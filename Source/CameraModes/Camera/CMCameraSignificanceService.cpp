@@ -0,0 +1,203 @@
+#include "CMCameraSignificanceService.h"
+
+#include "CMCameraStats.h"
+#include "CMSignificanceComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "HAL/IConsoleManager.h"
+
+DECLARE_CYCLE_STAT(TEXT("Significance ranking"), STAT_CMSignificance, STATGROUP_CameraModes);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Significance actors ranked"), STAT_CMSignificanceRanked, STATGROUP_CameraModes);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Significance bucket changes"), STAT_CMSignificanceChanges, STATGROUP_CameraModes);
+
+static TAutoConsoleVariable<int32> CVarCameraSignificanceMaxHigh(
+	TEXT("CameraModes.Significance.MaxHigh"),
+	16,
+	TEXT("Most significant actors ranked High."));
+
+static TAutoConsoleVariable<int32> CVarCameraSignificanceMaxMedium(
+	TEXT("CameraModes.Significance.MaxMedium"),
+	64,
+	TEXT("Actors ranked Medium after the High ones, the rest are Low."));
+
+static TAutoConsoleVariable<float> CVarCameraSignificanceMaxDistance(
+	TEXT("CameraModes.Significance.MaxDistance"),
+	10000.f,
+	TEXT("Distance from the camera at which significance reaches zero."));
+
+static TAutoConsoleVariable<float> CVarCameraSignificanceOffscreenScale(
+	TEXT("CameraModes.Significance.OffscreenScale"),
+	0.25f,
+	TEXT("Significance multiplier of actors outside the view frustum."));
+
+static TAutoConsoleVariable<float> CVarCameraSignificanceOccludedScale(
+	TEXT("CameraModes.Significance.OccludedScale"),
+	0.5f,
+	TEXT("Significance multiplier of actors the camera is fading out."));
+
+void UCMCameraSignificanceService::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	PostActorTickHandle = FWorldDelegates::OnWorldPostActorTick.AddUObject(this, &UCMCameraSignificanceService::OnWorldPostActorTick);
+}
+
+void UCMCameraSignificanceService::Deinitialize()
+{
+	FWorldDelegates::OnWorldPostActorTick.Remove(PostActorTickHandle);
+
+	Super::Deinitialize();
+}
+
+int32 UCMCameraSignificanceService::RegisterComponent(UCMSignificanceComponent* Component)
+{
+	if(Component == nullptr)
+	{
+		return INDEX_NONE;
+	}
+
+	const int32 handle = FreeHandles.Num() > 0 ? FreeHandles.Pop(false) : Components.AddDefaulted();
+	if(handle >= Significances.Num())
+	{
+		Significances.AddZeroed();
+		Buckets.AddDefaulted();
+	}
+
+	Components[handle] = Component;
+	Significances[handle] = 0.f;
+	Buckets[handle] = Component->GetSignificance();
+
+	return handle;
+}
+
+void UCMCameraSignificanceService::UnregisterComponent(int32 Handle)
+{
+	// The component may already be garbage when it unregisters, its handle is still in use until freed here
+	if(Components.IsValidIndex(Handle) && !FreeHandles.Contains(Handle))
+	{
+		Components[Handle].Reset();
+		FreeHandles.Add(Handle);
+	}
+}
+
+void UCMCameraSignificanceService::PublishView(const FVector& Location, const FRotator& Rotation, float FOV, float AspectRatio, TArrayView<AActor* const> Occluders)
+{
+	const float tanHalfHorizontal = FMath::Tan(FMath::DegreesToRadians(FMath::Clamp(FOV, 1.f, 170.f) * 0.5f));
+	const float tanHalfVertical = tanHalfHorizontal / FMath::Max(AspectRatio, KINDA_SMALL_NUMBER);
+
+	auto& view = Views.AddDefaulted_GetRef();
+	view.Location = Location;
+	view.Forward = Rotation.Vector();
+	view.CosHalfDiagonal = FMath::InvSqrt(1.f + FMath::Square(tanHalfHorizontal) + FMath::Square(tanHalfVertical));
+	view.Occluders.Append(Occluders.GetData(), Occluders.Num());
+}
+
+float UCMCameraSignificanceService::GetSignificance(int32 Handle) const
+{
+	return Significances.IsValidIndex(Handle) ? Significances[Handle] : 0.f;
+}
+
+int32 UCMCameraSignificanceService::GetNumRegistered() const
+{
+	return Components.Num() - FreeHandles.Num();
+}
+
+void UCMCameraSignificanceService::OnWorldPostActorTick(UWorld* World, ELevelTick TickType, float DeltaSeconds)
+{
+	if(World != GetWorld())
+	{
+		return;
+	}
+
+	// Without a view this frame, e.g. during a cutscene, the last ranking stays
+	if(Views.Num() > 0)
+	{
+		RankComponents();
+		Views.Reset();
+	}
+}
+
+void UCMCameraSignificanceService::RankComponents()
+{
+	SCOPE_CYCLE_COUNTER(STAT_CMSignificance);
+
+	const float invMaxDistance = 1.f / FMath::Max(CVarCameraSignificanceMaxDistance.GetValueOnGameThread(), 1.f);
+	const float offscreenScale = CVarCameraSignificanceOffscreenScale.GetValueOnGameThread();
+	const float occludedScale = CVarCameraSignificanceOccludedScale.GetValueOnGameThread();
+
+	RankedHandles.Reset();
+
+	for(int32 handle = 0; handle < Components.Num(); ++handle)
+	{
+		const auto component = Components[handle].Get();
+		const auto owner = component != nullptr ? component->GetOwner() : nullptr;
+		if(owner == nullptr)
+		{
+			continue;
+		}
+
+		const FVector location = owner->GetActorLocation();
+		const float radius = component->SignificanceRadius;
+
+		float significance = 0.f;
+		for(const auto& view : Views)
+		{
+			const FVector toActor = location - view.Location;
+			const float distance = toActor.Size();
+
+			float viewSignificance = 1.f - FMath::Min(distance * invMaxDistance, 1.f);
+			if(viewSignificance <= significance)
+			{
+				continue;
+			}
+
+			// Cone around the frustum, widened by the radius of the actor
+			const bool bOnScreen = distance <= radius || (toActor | view.Forward) >= distance * view.CosHalfDiagonal - radius;
+			if(!bOnScreen)
+			{
+				viewSignificance *= offscreenScale;
+			}
+			else if(view.Occluders.Contains(owner))
+			{
+				viewSignificance *= occludedScale;
+			}
+
+			significance = FMath::Max(significance, viewSignificance);
+		}
+
+		Significances[handle] = significance;
+		RankedHandles.Add(handle);
+	}
+
+	RankedHandles.Sort([this](int32 A, int32 B)
+	{
+		return Significances[A] > Significances[B];
+	});
+
+	const int32 maxHigh = FMath::Max(CVarCameraSignificanceMaxHigh.GetValueOnGameThread(), 0);
+	const int32 maxMedium = FMath::Max(CVarCameraSignificanceMaxMedium.GetValueOnGameThread(), 0);
+
+	int32 numChanges = 0;
+	for(int32 rank = 0; rank < RankedHandles.Num(); ++rank)
+	{
+		const int32 handle = RankedHandles[rank];
+		const ECMSignificance bucket = Significances[handle] <= 0.f || rank >= maxHigh + maxMedium ? ECMSignificance::Low
+			: rank >= maxHigh ? ECMSignificance::Medium
+			: ECMSignificance::High;
+
+		if(Buckets[handle] != bucket)
+		{
+			Buckets[handle] = bucket;
+			++numChanges;
+
+			// Listeners of earlier components may have destroyed this one
+			if(const auto component = Components[handle].Get())
+			{
+				component->SetSignificance(bucket);
+			}
+		}
+	}
+
+	INC_DWORD_STAT_BY(STAT_CMSignificanceRanked, RankedHandles.Num());
+	INC_DWORD_STAT_BY(STAT_CMSignificanceChanges, numChanges);
+}
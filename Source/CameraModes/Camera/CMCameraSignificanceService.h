@@ -0,0 +1,71 @@
+#pragma once
+
+#include "Subsystems/WorldSubsystem.h"
+
+#include "CMCameraSignificanceService.generated.h"
+
+class UCMSignificanceComponent;
+
+UENUM(BlueprintType)
+enum class ECMSignificance : uint8
+{
+	High,
+	Medium,
+	Low
+};
+
+/** Camera view published by a spring arm for the current frame */
+struct FCMCameraSignificanceView
+{
+public:
+	FVector Location = FVector::ZeroVector;
+	FVector Forward = FVector::ForwardVector;
+	/** Cosine of the angle between the view direction and a frustum corner */
+	float CosHalfDiagonal = 0.f;
+	/** Actors the arm currently fades, they count as hidden */
+	TArray<const AActor*, TInlineAllocator<16>> Occluders;
+};
+
+/**
+ * Ranks actors with a UCMSignificanceComponent by the camera views spring arms publish, once per frame for all of them.
+ * The most significant MaxHigh actors are High, the next MaxMedium Medium, the rest Low. Components only hear about bucket changes.
+ */
+UCLASS()
+class UCMCameraSignificanceService : public UWorldSubsystem
+{
+	GENERATED_BODY()
+public:
+	// USubsystem interface
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	// End of USubsystem interface
+
+	int32 RegisterComponent(UCMSignificanceComponent* Component);
+	void UnregisterComponent(int32 Handle);
+
+	/** Adds a view for this frame, views are dropped once the frame is ranked */
+	void PublishView(const FVector& Location, const FRotator& Rotation, float FOV, float AspectRatio, TArrayView<AActor* const> Occluders);
+
+	float GetSignificance(int32 Handle) const;
+
+	int32 GetNumRegistered() const;
+
+private:
+	void OnWorldPostActorTick(UWorld* World, ELevelTick TickType, float DeltaSeconds);
+
+	void RankComponents();
+
+private:
+	/** Registered components and their last result, indexed by handle */
+	TArray<TWeakObjectPtr<UCMSignificanceComponent>> Components;
+	TArray<float> Significances;
+	TArray<ECMSignificance> Buckets;
+	TArray<int32> FreeHandles;
+
+	TArray<FCMCameraSignificanceView, TInlineAllocator<2>> Views;
+
+	/** Scratch kept between frames */
+	TArray<int32> RankedHandles;
+
+	FDelegateHandle PostActorTickHandle;
+};
@@ -0,0 +1,8 @@
+#pragma once
+
+#include "Stats/Stats.h"
+
+DECLARE_STATS_GROUP(TEXT("CameraModes"), STATGROUP_CameraModes, STATCAT_Advanced);
+
+/** TCMFrameArray allocations that found no active arena and went to the heap */
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Frame array heap allocations"), STAT_CMFrameArrayHeapAllocations, STATGROUP_CameraModes, );
@@ -0,0 +1,222 @@
+#include "CMCameraTrack.h"
+
+#include "Algo/BinarySearch.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+
+namespace CMCameraTrack
+{
+	template<typename TKey, typename TValue, typename TLerp>
+	TValue SampleKeys(const TArray<TKey>& Keys, float Time, const TValue& DefaultValue, TLerp Lerp)
+	{
+		if(Keys.Num() == 0)
+		{
+			return DefaultValue;
+		}
+
+		const int32 nextIndex = Algo::UpperBoundBy(Keys, Time, [](const TKey& Key)
+		{
+			return Key.Time;
+		});
+
+		if(nextIndex == 0)
+		{
+			return Keys[0].Value;
+		}
+		if(nextIndex == Keys.Num())
+		{
+			return Keys.Last().Value;
+		}
+
+		const auto& key = Keys[nextIndex - 1];
+		const auto& nextKey = Keys[nextIndex];
+		const float alpha = nextKey.Time > key.Time ? (Time - key.Time) / (nextKey.Time - key.Time) : 1.f;
+		return Lerp(key.Value, nextKey.Value, alpha);
+	}
+
+	/** Ramer-Douglas-Peucker over time, a span keeps its sample with the largest error until every sample is within Tolerance */
+	template<typename TValue, typename TLerp, typename TError>
+	void ReduceKeys(const TArray<float>& Times, const TArray<TValue>& Values, float Tolerance, TLerp Lerp, TError Error, TArray<int32>& OutKeptIndices)
+	{
+		const int32 numSamples = Values.Num();
+		if(numSamples <= 2)
+		{
+			for(int32 index = 0; index < numSamples; ++index)
+			{
+				OutKeptIndices.Add(index);
+			}
+			return;
+		}
+
+		TBitArray<> keptSamples(false, numSamples);
+		keptSamples[0] = true;
+		keptSamples[numSamples - 1] = true;
+
+		TArray<TPair<int32, int32>> spans;
+		spans.Emplace(0, numSamples - 1);
+
+		while(spans.Num() > 0)
+		{
+			const auto span = spans.Pop(false);
+			const int32 first = span.Key;
+			const int32 last = span.Value;
+			const float spanTime = Times[last] - Times[first];
+
+			float maxError = Tolerance;
+			int32 maxErrorIndex = INDEX_NONE;
+			for(int32 index = first + 1; index < last; ++index)
+			{
+				const float alpha = spanTime > 0.f ? (Times[index] - Times[first]) / spanTime : 0.f;
+				const float error = Error(Lerp(Values[first], Values[last], alpha), Values[index]);
+				if(error > maxError)
+				{
+					maxError = error;
+					maxErrorIndex = index;
+				}
+			}
+
+			if(maxErrorIndex != INDEX_NONE)
+			{
+				keptSamples[maxErrorIndex] = true;
+				spans.Emplace(first, maxErrorIndex);
+				spans.Emplace(maxErrorIndex, last);
+			}
+		}
+
+		for(TConstSetBitIterator<> iterator(keptSamples); iterator; ++iterator)
+		{
+			OutKeptIndices.Add(iterator.GetIndex());
+		}
+	}
+
+	FVector LerpLocation(const FVector& A, const FVector& B, float Alpha)
+	{
+		return FMath::Lerp(A, B, Alpha);
+	}
+
+	FQuat LerpRotation(const FQuat& A, const FQuat& B, float Alpha)
+	{
+		return FQuat::Slerp(A, B, Alpha);
+	}
+
+	float LerpFOV(float A, float B, float Alpha)
+	{
+		return FMath::Lerp(A, B, Alpha);
+	}
+}
+
+void UCMCameraTrack::Sample(float Time, FTransform& OutCameraTransform, float& OutFOV) const
+{
+	OutCameraTransform.SetLocation(CMCameraTrack::SampleKeys(LocationKeys, Time, FVector::ZeroVector, &CMCameraTrack::LerpLocation));
+	OutCameraTransform.SetRotation(CMCameraTrack::SampleKeys(RotationKeys, Time, FQuat::Identity, &CMCameraTrack::LerpRotation));
+	OutCameraTransform.SetScale3D(FVector::OneVector);
+	OutFOV = CMCameraTrack::SampleKeys(FOVKeys, Time, 90.f, &CMCameraTrack::LerpFOV);
+}
+
+AActor* FCMCameraTrackFadeEvent::ResolveActor(const UWorld* World) const
+{
+#if WITH_EDITOR
+	if(World != nullptr && World->IsPlayInEditor())
+	{
+		FSoftObjectPath pieActorPath = Actor.ToSoftObjectPath();
+		pieActorPath.FixupForPIE(World->GetOutermost()->GetPIEInstanceID());
+		return Cast<AActor>(pieActorPath.ResolveObject());
+	}
+#endif
+	return Actor.Get();
+}
+
+void UCMCameraTrack::GetFadeEventRange(float FromTime, float ToTime, int32& OutFirstIndex, int32& OutEndIndex) const
+{
+	auto getTime = [](const FCMCameraTrackFadeEvent& FadeEvent)
+	{
+		return FadeEvent.Time;
+	};
+	
+	OutFirstIndex = Algo::LowerBoundBy(FadeEvents, FromTime, getTime);
+	OutEndIndex = FMath::Max(OutFirstIndex, Algo::LowerBoundBy(FadeEvents, ToTime, getTime));
+}
+
+int32 UCMCameraTrack::GetNumKeys() const
+{
+	return LocationKeys.Num() + RotationKeys.Num() + FOVKeys.Num();
+}
+
+void FCMCameraTrackBuilder::AddSample(float Time, const FTransform& CameraTransform, float FOV)
+{
+	Times.Add(Time);
+	Locations.Add(CameraTransform.GetLocation());
+	Rotations.Add(CameraTransform.GetRotation());
+	FOVs.Add(FOV);
+}
+
+void FCMCameraTrackBuilder::AddFadeEvent(float Time, AActor* Actor, bool bOccluding)
+{
+	auto& fadeEvent = FadeEvents.AddDefaulted_GetRef();
+	fadeEvent.Time = Time;
+	// Bakes run in PIE, the cooked game only knows the level's own path
+	fadeEvent.Actor = TSoftObjectPtr<AActor>(FSoftObjectPath(UWorld::RemovePIEPrefix(FSoftObjectPath(Actor).ToString())));
+	fadeEvent.bOccluding = bOccluding;
+}
+
+void FCMCameraTrackBuilder::Build(UCMCameraTrack& Track, float LocationTolerance, float RotationTolerance, float FOVTolerance) const
+{
+	Track.Duration = Times.Num() > 0 ? Times.Last() - Times[0] : 0.f;
+	Track.LocationKeys.Reset();
+	Track.RotationKeys.Reset();
+	Track.FOVKeys.Reset();
+	Track.FadeEvents.Reset();
+
+	const float startTime = Times.Num() > 0 ? Times[0] : 0.f;
+
+	TArray<int32> keptIndices;
+	CMCameraTrack::ReduceKeys(Times, Locations, LocationTolerance, &CMCameraTrack::LerpLocation, [](const FVector& A, const FVector& B)
+	{
+		return FVector::Dist(A, B);
+	}, keptIndices);
+	for(const auto index : keptIndices)
+	{
+		auto& key = Track.LocationKeys.AddDefaulted_GetRef();
+		key.Time = Times[index] - startTime;
+		key.Value = Locations[index];
+	}
+
+	keptIndices.Reset();
+	CMCameraTrack::ReduceKeys(Times, Rotations, RotationTolerance, &CMCameraTrack::LerpRotation, [](const FQuat& A, const FQuat& B)
+	{
+		return FMath::RadiansToDegrees(A.AngularDistance(B));
+	}, keptIndices);
+	for(const auto index : keptIndices)
+	{
+		auto& key = Track.RotationKeys.AddDefaulted_GetRef();
+		key.Time = Times[index] - startTime;
+		key.Value = Rotations[index];
+	}
+
+	keptIndices.Reset();
+	CMCameraTrack::ReduceKeys(Times, FOVs, FOVTolerance, &CMCameraTrack::LerpFOV, [](float A, float B)
+	{
+		return FMath::Abs(A - B);
+	}, keptIndices);
+	for(const auto index : keptIndices)
+	{
+		auto& key = Track.FOVKeys.AddDefaulted_GetRef();
+		key.Time = Times[index] - startTime;
+		key.Value = FOVs[index];
+	}
+
+	for(const auto& fadeEvent : FadeEvents)
+	{
+		auto& trackFadeEvent = Track.FadeEvents.Add_GetRef(fadeEvent);
+		trackFadeEvent.Time -= startTime;
+	}
+	Track.FadeEvents.StableSort([](const FCMCameraTrackFadeEvent& A, const FCMCameraTrackFadeEvent& B)
+	{
+		return A.Time < B.Time;
+	});
+}
+
+bool FCMCameraTrackBuilder::IsEmpty() const
+{
+	return Times.Num() == 0;
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include "Engine/DataAsset.h"
+
+#include "CMCameraTrack.generated.h"
+
+class AActor;
+class UWorld;
+
+USTRUCT()
+struct FCMCameraTrackLocationKey
+{
+	GENERATED_BODY()
+public:
+	UPROPERTY()
+	float Time = 0.f;
+
+	UPROPERTY()
+	FVector Value = FVector::ZeroVector;
+};
+
+USTRUCT()
+struct FCMCameraTrackRotationKey
+{
+	GENERATED_BODY()
+public:
+	UPROPERTY()
+	float Time = 0.f;
+
+	UPROPERTY()
+	FQuat Value = FQuat::Identity;
+};
+
+USTRUCT()
+struct FCMCameraTrackFOVKey
+{
+	GENERATED_BODY()
+public:
+	UPROPERTY()
+	float Time = 0.f;
+
+	UPROPERTY()
+	float Value = 90.f;
+};
+
+USTRUCT()
+struct FCMCameraTrackFadeEvent
+{
+	GENERATED_BODY()
+public:
+	UPROPERTY()
+	float Time = 0.f;
+
+	UPROPERTY()
+	TSoftObjectPtr<AActor> Actor;
+
+	/** True when the actor starts occluding and fades out, false when it fades back in */
+	UPROPERTY()
+	bool bOccluding = false;
+
+public:
+	/** Actor in World, Actor is stored without the PIE prefix and gets it back while playing in the editor */
+	AActor* ResolveActor(const UWorld* World) const;
+};
+
+/**
+ * Camera poses and fade events baked from the spring arm pipeline, see UCMCameraTrackBaker.
+ * Every channel keeps only the keys needed to stay within the bake tolerance, playback is linear interpolation between them.
+ */
+UCLASS(BlueprintType)
+class UCMCameraTrack : public UDataAsset
+{
+	GENERATED_BODY()
+public:
+	/** World space camera transform and FOV at Time, clamped to the track */
+	void Sample(float Time, FTransform& OutCameraTransform, float& OutFOV) const;
+
+	/** Index range [OutFirstIndex, OutEndIndex) of FadeEvents with FromTime <= Time < ToTime */
+	void GetFadeEventRange(float FromTime, float ToTime, int32& OutFirstIndex, int32& OutEndIndex) const;
+
+	int32 GetNumKeys() const;
+
+public:
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	float Duration = 0.f;
+
+	UPROPERTY()
+	TArray<FCMCameraTrackLocationKey> LocationKeys;
+
+	UPROPERTY()
+	TArray<FCMCameraTrackRotationKey> RotationKeys;
+
+	UPROPERTY()
+	TArray<FCMCameraTrackFOVKey> FOVKeys;
+
+	/** Sorted by time */
+	UPROPERTY()
+	TArray<FCMCameraTrackFadeEvent> FadeEvents;
+};
+
+/** Collects uniformly or irregularly timed samples and writes them to a track with the keys reduced to a tolerance */
+class FCMCameraTrackBuilder
+{
+public:
+	void AddSample(float Time, const FTransform& CameraTransform, float FOV);
+	void AddFadeEvent(float Time, AActor* Actor, bool bOccluding);
+
+	/**
+	 * Keeps the fewest keys whose linear interpolation stays within the tolerances of every sample.
+	 * @param LocationTolerance centimeters
+	 * @param RotationTolerance degrees
+	 * @param FOVTolerance degrees
+	 */
+	void Build(UCMCameraTrack& Track, float LocationTolerance, float RotationTolerance, float FOVTolerance) const;
+
+	bool IsEmpty() const;
+
+private:
+	TArray<float> Times;
+	TArray<FVector> Locations;
+	TArray<FQuat> Rotations;
+	TArray<float> FOVs;
+	TArray<FCMCameraTrackFadeEvent> FadeEvents;
+};
@@ -0,0 +1,133 @@
+#include "CMCameraTrackBaker.h"
+
+#include "CMCameraTrack.h"
+#include "CMSpringArmComponent.h"
+#include "CameraSubsystems/CMCameraSubsystem_Fade.h"
+#include "Camera/PlayerCameraManager.h"
+#include "Components/SplineComponent.h"
+#include "GameFramework/PlayerController.h"
+
+#if WITH_EDITOR
+#include "AssetRegistryModule.h"
+#include "Misc/PackageName.h"
+#include "UObject/Package.h"
+#endif
+
+UCMCameraTrack* UCMCameraTrackBaker::BakeSplinePath(UCMSpringArmComponent* SpringArm, USplineComponent* PawnPath, float Duration, float SampleRate, float LocationTolerance, float RotationTolerance, float FOVTolerance)
+{
+	if(SpringArm == nullptr || PawnPath == nullptr || SampleRate <= 0.f)
+	{
+		return nullptr;
+	}
+
+	const auto owner = SpringArm->GetOwner();
+	const auto playerController = SpringArm->GetOwningController();
+	if(playerController == nullptr)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Camera track bake of %s needs a possessed pawn"), *owner->GetName());
+		return nullptr;
+	}
+
+	const FTransform savedOwnerTransform = owner->GetActorTransform();
+	const FRotator savedControlRotation = playerController->GetControlRotation();
+
+	FCMCameraTrackBuilder trackBuilder;
+	float bakeTime = 0.f;
+
+	// The world does not tick between steps, so async traces would never complete
+	SpringArm->SetAsyncProbesSuspended(true);
+
+	FDelegateHandle occluderChangedHandle;
+	FCMCameraFadeState savedFadeState;
+	const auto fadeSubsystem = SpringArm->GetCameraSubsystem<UCMCameraSubsystem_Fade>();
+	if(fadeSubsystem != nullptr)
+	{
+		savedFadeState = fadeSubsystem->SaveFadeState();
+		occluderChangedHandle = fadeSubsystem->OnOccluderChanged.AddLambda([&trackBuilder, &bakeTime](AActor* Actor, bool bOccluding)
+		{
+			trackBuilder.AddFadeEvent(bakeTime, Actor, bOccluding);
+		});
+	}
+
+	const float deltaTime = 1.f / SampleRate;
+	const int32 numSteps = FMath::Max(1, FMath::CeilToInt(Duration * SampleRate));
+	const float pathLength = PawnPath->GetSplineLength();
+
+	for(int32 step = 0; step <= numSteps; ++step)
+	{
+		bakeTime = FMath::Min(step * deltaTime, Duration);
+
+		const float distance = Duration > 0.f ? pathLength * bakeTime / Duration : 0.f;
+		const FRotator pathRotation = PawnPath->GetRotationAtDistanceAlongSpline(distance, ESplineCoordinateSpace::World);
+		owner->SetActorLocationAndRotation(PawnPath->GetLocationAtDistanceAlongSpline(distance, ESplineCoordinateSpace::World), pathRotation);
+		playerController->SetControlRotation(pathRotation);
+
+		SpringArm->TickComponent(step == 0 ? 0.f : deltaTime, LEVELTICK_All, nullptr);
+
+		const float fov = playerController->PlayerCameraManager != nullptr ? playerController->PlayerCameraManager->GetFOVAngle() : 90.f;
+		trackBuilder.AddSample(bakeTime, SpringArm->GetSocketTransform(NAME_None, RTS_World), fov);
+	}
+
+	if(fadeSubsystem != nullptr)
+	{
+		fadeSubsystem->OnOccluderChanged.Remove(occluderChangedHandle);
+		fadeSubsystem->RestoreFadeState(savedFadeState);
+	}
+
+	SpringArm->SetAsyncProbesSuspended(false);
+
+	owner->SetActorTransform(savedOwnerTransform);
+	playerController->SetControlRotation(savedControlRotation);
+
+	const auto cameraTrack = NewObject<UCMCameraTrack>();
+	trackBuilder.Build(*cameraTrack, LocationTolerance, RotationTolerance, FOVTolerance);
+	return cameraTrack;
+}
+
+UCMCameraTrack* UCMCameraTrackBaker::BakePoseHistory(UCMSpringArmComponent* SpringArm, float SampleRate, float LocationTolerance, float RotationTolerance, float FOVTolerance)
+{
+	if(SpringArm == nullptr || SampleRate <= 0.f || SpringArm->GetPoseHistory().IsEmpty())
+	{
+		return nullptr;
+	}
+
+	const auto& poseHistory = SpringArm->GetPoseHistory();
+	const float oldestTime = poseHistory.GetOldestTime();
+	const float newestTime = poseHistory.GetNewestTime();
+
+	FCMCameraTrackBuilder trackBuilder;
+	for(float time = oldestTime; time <= newestTime; time += 1.f / SampleRate)
+	{
+		FCMCameraPose cameraPose;
+		poseHistory.SamplePose(time, cameraPose);
+		trackBuilder.AddSample(time, FTransform(cameraPose.Rotation, cameraPose.Location), cameraPose.FOV);
+	}
+
+	const auto cameraTrack = NewObject<UCMCameraTrack>();
+	trackBuilder.Build(*cameraTrack, LocationTolerance, RotationTolerance, FOVTolerance);
+	return cameraTrack;
+}
+
+#if WITH_EDITOR
+UCMCameraTrack* UCMCameraTrackBaker::SaveCameraTrack(UCMCameraTrack* CameraTrack, const FString& PackagePath)
+{
+	if(CameraTrack == nullptr || !FPackageName::IsValidLongPackageName(PackagePath))
+	{
+		return nullptr;
+	}
+
+	const auto package = CreatePackage(*PackagePath);
+	const auto savedCameraTrack = DuplicateObject<UCMCameraTrack>(CameraTrack, package, *FPackageName::GetShortName(PackagePath));
+	savedCameraTrack->SetFlags(RF_Public | RF_Standalone);
+
+	FAssetRegistryModule::AssetCreated(savedCameraTrack);
+	package->MarkPackageDirty();
+
+	const FString packageFileName = FPackageName::LongPackageNameToFilename(PackagePath, FPackageName::GetAssetPackageExtension());
+	if(!UPackage::SavePackage(package, savedCameraTrack, RF_Public | RF_Standalone, *packageFileName))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Failed to save camera track %s"), *PackagePath);
+	}
+	return savedCameraTrack;
+}
+#endif
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "Kismet/BlueprintFunctionLibrary.h"
+
+#include "CMCameraTrackBaker.generated.h"
+
+class UCMCameraTrack;
+class UCMSpringArmComponent;
+class USplineComponent;
+
+/**
+ * Bakes the spring arm pipeline into UCMCameraTrack assets for scripted sequences.
+ * Baking runs in a game world (PIE), the spring arm needs an owning player controller to evaluate.
+ */
+UCLASS()
+class UCMCameraTrackBaker : public UBlueprintFunctionLibrary
+{
+	GENERATED_BODY()
+public:
+	/**
+	 * Moves the spring arm owner along PawnPath over Duration seconds, ticks the arm at SampleRate and records camera poses and fade events.
+	 * Whisker probes and lock-on line of sight are skipped, their async traces need the world to tick.
+	 * The owner and the fades are put back the way they were afterwards. Returns a transient track, see SaveCameraTrack.
+	 */
+	UFUNCTION(BlueprintCallable, Category="Camera Modes|Bake")
+	static UCMCameraTrack* BakeSplinePath(UCMSpringArmComponent* SpringArm, USplineComponent* PawnPath, float Duration = 5.f, float SampleRate = 60.f, float LocationTolerance = 1.f, float RotationTolerance = 0.5f, float FOVTolerance = 0.1f);
+
+	/** Converts the pose history the spring arm recorded while the sequence was played live. Fade events are not part of the history. */
+	UFUNCTION(BlueprintCallable, Category="Camera Modes|Bake")
+	static UCMCameraTrack* BakePoseHistory(UCMSpringArmComponent* SpringArm, float SampleRate = 60.f, float LocationTolerance = 1.f, float RotationTolerance = 0.5f, float FOVTolerance = 0.1f);
+
+#if WITH_EDITOR
+	/** Saves a baked track as an asset, e.g. PackagePath "/Game/Cinematics/CT_Intro" */
+	UFUNCTION(BlueprintCallable, Category="Camera Modes|Bake")
+	static UCMCameraTrack* SaveCameraTrack(UCMCameraTrack* CameraTrack, const FString& PackagePath);
+#endif
+};
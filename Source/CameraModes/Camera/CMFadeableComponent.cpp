@@ -0,0 +1,54 @@
+#include "CMFadeableComponent.h"
+
+#include "CMFadeableRegistry.h"
+#include "Components/PrimitiveComponent.h"
+#include "Engine/World.h"
+
+UCMFadeableComponent::UCMFadeableComponent()
+{
+	PrimaryComponentTick.bCanEverTick = false;
+}
+
+void UCMFadeableComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if(const auto registry = GetWorld()->GetSubsystem<UCMFadeableRegistry>())
+	{
+		TArray<UPrimitiveComponent*> primitiveComponents;
+		GetOwner()->GetComponents(primitiveComponents);
+
+		for(const auto primitiveComponent : primitiveComponents)
+		{
+			if(primitiveComponent != nullptr && primitiveComponent->IsRegistered())
+			{
+				RegisteredHandles.Add(registry->RegisterPrimitive(primitiveComponent));
+			}
+		}
+	}
+}
+
+void UCMFadeableComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if(const auto registry = GetWorld()->GetSubsystem<UCMFadeableRegistry>())
+	{
+		for(const auto handle : RegisteredHandles)
+		{
+			registry->UnregisterPrimitive(handle);
+		}
+	}
+	RegisteredHandles.Reset();
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void UCMFadeableComponent::UpdateRegistration()
+{
+	if(const auto registry = GetWorld()->GetSubsystem<UCMFadeableRegistry>())
+	{
+		for(const auto handle : RegisteredHandles)
+		{
+			registry->UpdatePrimitive(handle);
+		}
+	}
+}
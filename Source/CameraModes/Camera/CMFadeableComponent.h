@@ -0,0 +1,29 @@
+#pragma once
+
+#include "Components/ActorComponent.h"
+
+#include "CMFadeableComponent.generated.h"
+
+/**
+ * Marks the owning actor as an occluder that camera Fade subsystems may fade.
+ * Registers the owner's primitives in the world's UCMFadeableRegistry.
+ */
+UCLASS(meta=(BlueprintSpawnableComponent))
+class UCMFadeableComponent : public UActorComponent
+{
+	GENERATED_BODY()
+public:
+	UCMFadeableComponent();
+
+	// UActorComponent interface
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	// End of UActorComponent interface
+
+	/** Re-reads bounds of the registered primitives. Call it after moving the owner. */
+	UFUNCTION(BlueprintCallable)
+	void UpdateRegistration();
+
+private:
+	TArray<int32> RegisteredHandles;
+};
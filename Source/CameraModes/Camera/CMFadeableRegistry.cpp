@@ -0,0 +1,234 @@
+#include "CMFadeableRegistry.h"
+
+#include "Components/PrimitiveComponent.h"
+#include "GameFramework/Actor.h"
+
+namespace CMFadeableRegistry
+{
+	// Replaces 1/0 for axis aligned segments, keeps slab math free of NaNs.
+	constexpr float BigInvDir = 1e30f;
+
+	FORCEINLINE void SlabAxis(const VectorRegister& BoxMin, const VectorRegister& BoxMax, const VectorRegister& Start, const VectorRegister& InvDir, const VectorRegister& Extent, VectorRegister& TMin, VectorRegister& TMax)
+	{
+		const VectorRegister t1 = VectorMultiply(VectorSubtract(VectorSubtract(BoxMin, Extent), Start), InvDir);
+		const VectorRegister t2 = VectorMultiply(VectorSubtract(VectorAdd(BoxMax, Extent), Start), InvDir);
+		TMin = VectorMax(TMin, VectorMin(t1, t2));
+		TMax = VectorMin(TMax, VectorMax(t1, t2));
+	}
+
+	FORCEINLINE void SlabAxis(float BoxMin, float BoxMax, float Start, float InvDir, float Extent, float& TMin, float& TMax)
+	{
+		const float t1 = (BoxMin - Extent - Start) * InvDir;
+		const float t2 = (BoxMax + Extent - Start) * InvDir;
+		TMin = FMath::Max(TMin, FMath::Min(t1, t2));
+		TMax = FMath::Min(TMax, FMath::Max(t1, t2));
+	}
+}
+
+int32 UCMFadeableRegistry::RegisterPrimitive(UPrimitiveComponent* Primitive)
+{
+	if(Primitive == nullptr)
+	{
+		return INDEX_NONE;
+	}
+
+	const int32 entryIndex = FreeEntries.Num() > 0 ? FreeEntries.Pop(false) : Entries.AddDefaulted();
+
+	auto& entry = Entries[entryIndex];
+	entry.Primitive = Primitive;
+	entry.Actor = Primitive->GetOwner();
+	entry.Bounds = Primitive->Bounds.GetBox();
+	entry.bInUse = true;
+	entry.QueryStamp = 0;
+
+	AddToCells(entryIndex);
+
+	return entryIndex;
+}
+
+void UCMFadeableRegistry::UnregisterPrimitive(int32 Handle)
+{
+	if(Entries.IsValidIndex(Handle) && Entries[Handle].bInUse)
+	{
+		RemoveFromCells(Handle);
+
+		Entries[Handle] = FEntry();
+		FreeEntries.Add(Handle);
+	}
+}
+
+void UCMFadeableRegistry::UpdatePrimitive(int32 Handle)
+{
+	if(Entries.IsValidIndex(Handle) && Entries[Handle].bInUse)
+	{
+		auto& entry = Entries[Handle];
+		if(const auto primitive = entry.Primitive.Get())
+		{
+			RemoveFromCells(Handle);
+			entry.Bounds = primitive->Bounds.GetBox();
+			AddToCells(Handle);
+		}
+	}
+}
+
+void UCMFadeableRegistry::QuerySegment(const FVector& Start, const FVector& End, const FVector& Extent, TCMFrameArray<AActor*>& OutActors)
+{
+	++CurrentQueryStamp;
+
+	const FVector direction = End - Start;
+	FVector invDir;
+	for(int32 axis = 0; axis < 3; ++axis)
+	{
+		invDir[axis] = FMath::Abs(direction[axis]) > KINDA_SMALL_NUMBER ? 1.f / direction[axis] : CMFadeableRegistry::BigInvDir;
+	}
+
+	const FIntVector minCell = Grid.GetCellCoord(Start.ComponentMin(End) - Extent);
+	const FIntVector maxCell = Grid.GetCellCoord(Start.ComponentMax(End) + Extent);
+
+	Grid.ForEachCell(minCell, maxCell, [this, &Start, &invDir, &Extent, &OutActors](FCell& Cell)
+	{
+		QueryCell(Cell, Start, invDir, Extent, OutActors);
+	});
+
+	QueryCell(Grid.GetOversizedCell(), Start, invDir, Extent, OutActors);
+}
+
+int32 UCMFadeableRegistry::GetNumRegistered() const
+{
+	return Entries.Num() - FreeEntries.Num();
+}
+
+void UCMFadeableRegistry::QueryCell(FCell& Cell, const FVector& Start, const FVector& InvDir, const FVector& Extent, TCMFrameArray<AActor*>& OutActors)
+{
+	const int32 numEntries = Cell.EntryIndices.Num();
+	const int32 numVectorized = numEntries & ~3;
+
+	auto addHit = [this, &OutActors](int32 EntryIndex)
+	{
+		auto& entry = Entries[EntryIndex];
+		if(entry.QueryStamp != CurrentQueryStamp)
+		{
+			entry.QueryStamp = CurrentQueryStamp;
+			if(const auto actor = entry.Actor.Get())
+			{
+				OutActors.AddUnique(actor);
+			}
+		}
+	};
+
+	const VectorRegister startX = VectorSetFloat1(Start.X);
+	const VectorRegister startY = VectorSetFloat1(Start.Y);
+	const VectorRegister startZ = VectorSetFloat1(Start.Z);
+	const VectorRegister invDirX = VectorSetFloat1(InvDir.X);
+	const VectorRegister invDirY = VectorSetFloat1(InvDir.Y);
+	const VectorRegister invDirZ = VectorSetFloat1(InvDir.Z);
+	const VectorRegister extentX = VectorSetFloat1(Extent.X);
+	const VectorRegister extentY = VectorSetFloat1(Extent.Y);
+	const VectorRegister extentZ = VectorSetFloat1(Extent.Z);
+
+	for(int32 index = 0; index < numVectorized; index += 4)
+	{
+		VectorRegister tMin = VectorZero();
+		VectorRegister tMax = VectorOne();
+
+		CMFadeableRegistry::SlabAxis(VectorLoad(Cell.MinX.GetData() + index), VectorLoad(Cell.MaxX.GetData() + index), startX, invDirX, extentX, tMin, tMax);
+		CMFadeableRegistry::SlabAxis(VectorLoad(Cell.MinY.GetData() + index), VectorLoad(Cell.MaxY.GetData() + index), startY, invDirY, extentY, tMin, tMax);
+		CMFadeableRegistry::SlabAxis(VectorLoad(Cell.MinZ.GetData() + index), VectorLoad(Cell.MaxZ.GetData() + index), startZ, invDirZ, extentZ, tMin, tMax);
+
+		const int32 hitMask = VectorMaskBits(VectorCompareGE(tMax, tMin));
+		if(hitMask != 0)
+		{
+			for(int32 lane = 0; lane < 4; ++lane)
+			{
+				if(hitMask & (1 << lane))
+				{
+					addHit(Cell.EntryIndices[index + lane]);
+				}
+			}
+		}
+	}
+
+	for(int32 index = numVectorized; index < numEntries; ++index)
+	{
+		float tMin = 0.f;
+		float tMax = 1.f;
+
+		CMFadeableRegistry::SlabAxis(Cell.MinX[index], Cell.MaxX[index], Start.X, InvDir.X, Extent.X, tMin, tMax);
+		CMFadeableRegistry::SlabAxis(Cell.MinY[index], Cell.MaxY[index], Start.Y, InvDir.Y, Extent.Y, tMin, tMax);
+		CMFadeableRegistry::SlabAxis(Cell.MinZ[index], Cell.MaxZ[index], Start.Z, InvDir.Z, Extent.Z, tMin, tMax);
+
+		if(tMax >= tMin)
+		{
+			addHit(Cell.EntryIndices[index]);
+		}
+	}
+}
+
+void UCMFadeableRegistry::AddToCells(int32 EntryIndex)
+{
+	auto& entry = Entries[EntryIndex];
+
+	entry.MinCell = Grid.GetCellCoord(entry.Bounds.Min);
+	entry.MaxCell = Grid.GetCellCoord(entry.Bounds.Max);
+	entry.bOversized = Grid.IsOversized(entry.MinCell, entry.MaxCell);
+
+	if(entry.bOversized)
+	{
+		AddToCell(Grid.GetOversizedCell(), EntryIndex, entry.Bounds);
+		return;
+	}
+
+	Grid.ForEachCellCoord(entry.MinCell, entry.MaxCell, [this, EntryIndex, &entry](const FIntVector& CellCoord)
+	{
+		AddToCell(Grid.FindOrAddCell(CellCoord), EntryIndex, entry.Bounds);
+	});
+}
+
+void UCMFadeableRegistry::RemoveFromCells(int32 EntryIndex)
+{
+	const auto& entry = Entries[EntryIndex];
+
+	if(entry.bOversized)
+	{
+		RemoveFromCell(Grid.GetOversizedCell(), EntryIndex);
+		return;
+	}
+
+	Grid.ForEachCellCoord(entry.MinCell, entry.MaxCell, [this, EntryIndex](const FIntVector& CellCoord)
+	{
+		if(const auto cell = Grid.FindCell(CellCoord))
+		{
+			RemoveFromCell(*cell, EntryIndex);
+			if(cell->EntryIndices.Num() == 0)
+			{
+				Grid.RemoveCell(CellCoord);
+			}
+		}
+	});
+}
+
+void UCMFadeableRegistry::AddToCell(FCell& Cell, int32 EntryIndex, const FBox& Bounds)
+{
+	Cell.MinX.Add(Bounds.Min.X);
+	Cell.MinY.Add(Bounds.Min.Y);
+	Cell.MinZ.Add(Bounds.Min.Z);
+	Cell.MaxX.Add(Bounds.Max.X);
+	Cell.MaxY.Add(Bounds.Max.Y);
+	Cell.MaxZ.Add(Bounds.Max.Z);
+	Cell.EntryIndices.Add(EntryIndex);
+}
+
+void UCMFadeableRegistry::RemoveFromCell(FCell& Cell, int32 EntryIndex)
+{
+	const int32 index = Cell.EntryIndices.Find(EntryIndex);
+	if(index != INDEX_NONE)
+	{
+		Cell.MinX.RemoveAtSwap(index, 1, false);
+		Cell.MinY.RemoveAtSwap(index, 1, false);
+		Cell.MinZ.RemoveAtSwap(index, 1, false);
+		Cell.MaxX.RemoveAtSwap(index, 1, false);
+		Cell.MaxY.RemoveAtSwap(index, 1, false);
+		Cell.MaxZ.RemoveAtSwap(index, 1, false);
+		Cell.EntryIndices.RemoveAtSwap(index, 1, false);
+	}
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "CMCameraFrameArena.h"
+#include "CMUniformGrid.h"
+#include "Subsystems/WorldSubsystem.h"
+
+#include "CMFadeableRegistry.generated.h"
+
+class AActor;
+class UPrimitiveComponent;
+
+/**
+ * Per-world spatial hash of primitives that are allowed to fade.
+ * Bounds are stored per cell as SoA arrays, so a camera-to-pawn query is a handful of
+ * vectorized slab tests instead of a physics scene query.
+ */
+UCLASS()
+class UCMFadeableRegistry : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+	struct FCell
+	{
+	public:
+		TArray<float> MinX;
+		TArray<float> MinY;
+		TArray<float> MinZ;
+		TArray<float> MaxX;
+		TArray<float> MaxY;
+		TArray<float> MaxZ;
+		TArray<int32> EntryIndices;
+	};
+
+	struct FEntry
+	{
+	public:
+		TWeakObjectPtr<UPrimitiveComponent> Primitive;
+		TWeakObjectPtr<AActor> Actor;
+		FBox Bounds = FBox(ForceInit);
+		FIntVector MinCell = FIntVector::ZeroValue;
+		FIntVector MaxCell = FIntVector::ZeroValue;
+		bool bOversized = false;
+		bool bInUse = false;
+		uint32 QueryStamp = 0;
+	};
+
+public:
+	int32 RegisterPrimitive(UPrimitiveComponent* Primitive);
+	void UnregisterPrimitive(int32 Handle);
+	void UpdatePrimitive(int32 Handle);
+
+	/**
+	 * Collects owners of registered primitives whose bounds intersect the box swept from Start to End.
+	 * @param Extent half size of the swept axis aligned box
+	 */
+	void QuerySegment(const FVector& Start, const FVector& End, const FVector& Extent, TCMFrameArray<AActor*>& OutActors);
+
+	int32 GetNumRegistered() const;
+
+public:
+	/** Size of the hash cells. Primitives spanning more than MaxCellsPerPrimitive cells go to a single oversized bucket. */
+	static constexpr float CellSize = 1000.f;
+	static constexpr int32 MaxCellsPerPrimitive = 64;
+
+private:
+	void AddToCells(int32 EntryIndex);
+	void RemoveFromCells(int32 EntryIndex);
+
+	static void AddToCell(FCell& Cell, int32 EntryIndex, const FBox& Bounds);
+	static void RemoveFromCell(FCell& Cell, int32 EntryIndex);
+
+	void QueryCell(FCell& Cell, const FVector& Start, const FVector& InvDir, const FVector& Extent, TCMFrameArray<AActor*>& OutActors);
+
+private:
+	TCMUniformGrid<FCell> Grid = TCMUniformGrid<FCell>(CellSize, MaxCellsPerPrimitive);
+
+	TArray<FEntry> Entries;
+	TArray<int32> FreeEntries;
+
+	uint32 CurrentQueryStamp = 0;
+};
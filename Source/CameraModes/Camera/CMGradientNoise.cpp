@@ -0,0 +1,87 @@
+#include "CMGradientNoise.h"
+
+#include "Math/RandomStream.h"
+
+namespace CMGradientNoise
+{
+	struct FTables
+	{
+	public:
+		FTables()
+		{
+			// Fixed seed, the same noise on every machine and every run
+			FRandomStream randomStream(0x43414d);
+
+			for(int32 index = 0; index < FCMGradientNoise::TableSize; ++index)
+			{
+				Gradients[index] = randomStream.FRandRange(-1.f, 1.f);
+				Permutation[index] = (uint8)index;
+			}
+
+			for(int32 index = FCMGradientNoise::TableSize - 1; index > 0; --index)
+			{
+				Swap(Permutation[index], Permutation[randomStream.RandHelper(index + 1)]);
+			}
+		}
+
+		FORCEINLINE float GetGradient(int32 Lattice) const
+		{
+			return Gradients[Permutation[Lattice & (FCMGradientNoise::TableSize - 1)]];
+		}
+
+	public:
+		float Gradients[FCMGradientNoise::TableSize];
+		uint8 Permutation[FCMGradientNoise::TableSize];
+	};
+
+	const FTables& GetTables()
+	{
+		static const FTables tables;
+		return tables;
+	}
+
+	/** Gradient noise peaks at half the gradient magnitude, scale it back to [-1, 1] */
+	constexpr float OutputScale = 2.f;
+}
+
+void FCMGradientNoise::Evaluate(const float* Inputs, float* Outputs, int32 Num)
+{
+	check(Num % 4 == 0);
+
+	const auto& tables = CMGradientNoise::GetTables();
+
+	const VectorRegister one = VectorOne();
+	const VectorRegister six = VectorSetFloat1(6.f);
+	const VectorRegister fifteen = VectorSetFloat1(15.f);
+	const VectorRegister ten = VectorSetFloat1(10.f);
+	const VectorRegister outputScale = VectorSetFloat1(CMGradientNoise::OutputScale);
+
+	MS_ALIGN(16) float lattice[4] GCC_ALIGN(16);
+	MS_ALIGN(16) float gradients0[4] GCC_ALIGN(16);
+	MS_ALIGN(16) float gradients1[4] GCC_ALIGN(16);
+
+	for(int32 index = 0; index < Num; index += 4)
+	{
+		const VectorRegister input = VectorLoadAligned(Inputs + index);
+		const VectorRegister floor = VectorFloor(input);
+		const VectorRegister fraction = VectorSubtract(input, floor);
+
+		VectorStoreAligned(floor, lattice);
+		for(int32 lane = 0; lane < 4; ++lane)
+		{
+			const int32 latticeIndex = (int32)lattice[lane];
+			gradients0[lane] = tables.GetGradient(latticeIndex);
+			gradients1[lane] = tables.GetGradient(latticeIndex + 1);
+		}
+
+		const VectorRegister ramp0 = VectorMultiply(VectorLoadAligned(gradients0), fraction);
+		const VectorRegister ramp1 = VectorMultiply(VectorLoadAligned(gradients1), VectorSubtract(fraction, one));
+
+		// 6t^5 - 15t^4 + 10t^3
+		const VectorRegister fade = VectorMultiply(VectorMultiply(VectorMultiply(fraction, fraction), fraction),
+			VectorMultiplyAdd(fraction, VectorMultiplyAdd(fraction, six, VectorNegate(fifteen)), ten));
+
+		const VectorRegister noise = VectorMultiplyAdd(VectorSubtract(ramp1, ramp0), fade, ramp0);
+		VectorStoreAligned(VectorMultiply(noise, outputScale), Outputs + index);
+	}
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * 1D gradient noise from precomputed permutation and gradient tables.
+ * Evaluated in batches, the fade curve and interpolation run 4 lanes at a time, only the table lookups are scalar.
+ */
+class FCMGradientNoise
+{
+public:
+	/** Noise in [-1, 1] for every input. Num must be a multiple of 4, Inputs and Outputs 16 byte aligned. */
+	static void Evaluate(const float* Inputs, float* Outputs, int32 Num);
+
+public:
+	static constexpr int32 TableSize = 256;
+};
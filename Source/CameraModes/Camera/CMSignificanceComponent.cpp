@@ -0,0 +1,110 @@
+#include "CMSignificanceComponent.h"
+
+#include "Components/SkeletalMeshComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+
+UCMSignificanceComponent::UCMSignificanceComponent()
+{
+	PrimaryComponentTick.bCanEverTick = false;
+
+	// Animation is the tick worth throttling by default
+	ThrottledComponentClasses.Add(USkeletalMeshComponent::StaticClass());
+}
+
+void UCMSignificanceComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if(const auto service = GetWorld()->GetSubsystem<UCMCameraSignificanceService>())
+	{
+		RegistryHandle = service->RegisterComponent(this);
+	}
+}
+
+void UCMSignificanceComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if(const auto service = GetWorld()->GetSubsystem<UCMCameraSignificanceService>())
+	{
+		service->UnregisterComponent(RegistryHandle);
+	}
+	RegistryHandle = INDEX_NONE;
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void UCMSignificanceComponent::SetSignificance(ECMSignificance NewSignificance)
+{
+	if(Significance != NewSignificance)
+	{
+		Significance = NewSignificance;
+
+		if(bThrottleTicks)
+		{
+			ApplyTickInterval();
+		}
+		OnSignificanceChanged.Broadcast(Significance);
+	}
+}
+
+ECMSignificance UCMSignificanceComponent::GetSignificance() const
+{
+	return Significance;
+}
+
+void UCMSignificanceComponent::GatherThrottledComponents()
+{
+	bThrottledComponentsGathered = true;
+
+	const auto owner = GetOwner();
+	OriginalActorTickInterval = owner->GetActorTickInterval();
+
+	for(const auto component : owner->GetComponents())
+	{
+		if(component == nullptr || component == this || !component->PrimaryComponentTick.bCanEverTick)
+		{
+			continue;
+		}
+
+		for(const auto& throttledClass : ThrottledComponentClasses)
+		{
+			if(throttledClass != nullptr && component->IsA(throttledClass))
+			{
+				ThrottledComponents.Add(component);
+				OriginalTickIntervals.Add(component->GetComponentTickInterval());
+				break;
+			}
+		}
+	}
+}
+
+void UCMSignificanceComponent::ApplyTickInterval()
+{
+	const auto owner = GetOwner();
+	if(owner == nullptr)
+	{
+		return;
+	}
+
+	if(!bThrottledComponentsGathered)
+	{
+		GatherThrottledComponents();
+	}
+
+	const float tickInterval = Significance == ECMSignificance::High ? HighTickInterval
+		: Significance == ECMSignificance::Medium ? MediumTickInterval
+		: LowTickInterval;
+
+	if(bThrottleActorTick)
+	{
+		owner->SetActorTickInterval(FMath::Max(OriginalActorTickInterval, tickInterval));
+	}
+
+	for(int32 index = 0; index < ThrottledComponents.Num(); ++index)
+	{
+		if(const auto component = ThrottledComponents[index].Get())
+		{
+			component->SetComponentTickInterval(FMath::Max(OriginalTickIntervals[index], tickInterval));
+		}
+	}
+}
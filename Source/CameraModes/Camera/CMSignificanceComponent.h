@@ -0,0 +1,75 @@
+#pragma once
+
+#include "CMCameraSignificanceService.h"
+#include "Components/ActorComponent.h"
+
+#include "CMSignificanceComponent.generated.h"
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FCMOnSignificanceChanged, ECMSignificance, Significance);
+
+/**
+ * Lets UCMCameraSignificanceService rank the owner against the camera views.
+ * Throttles the ticks of opted in components by significance, skeletal mesh animation by default, and reports changes for custom LOD.
+ */
+UCLASS(meta=(BlueprintSpawnableComponent))
+class UCMSignificanceComponent : public UActorComponent
+{
+	GENERATED_BODY()
+public:
+	UCMSignificanceComponent();
+
+	// UActorComponent interface
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	// End of UActorComponent interface
+
+	/** Called by the service when the owner moved to another bucket */
+	void SetSignificance(ECMSignificance NewSignificance);
+
+	UFUNCTION(BlueprintPure)
+	ECMSignificance GetSignificance() const;
+
+public:
+	/** Bounding radius used for the frustum test */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, meta=(ClampMin="0.0"))
+	float SignificanceRadius = 100.f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly)
+	bool bThrottleTicks = true;
+
+	/** Owner components of these classes are throttled, movement and camera components keep their own rate unless listed */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, meta=(EditCondition="bThrottleTicks"))
+	TArray<TSubclassOf<UActorComponent>> ThrottledComponentClasses;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, meta=(EditCondition="bThrottleTicks"))
+	bool bThrottleActorTick = false;
+
+	/** Tick intervals per bucket, never faster than the interval a component had before it was throttled */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, meta=(EditCondition="bThrottleTicks", ClampMin="0.0"))
+	float HighTickInterval = 0.f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, meta=(EditCondition="bThrottleTicks", ClampMin="0.0"))
+	float MediumTickInterval = 0.1f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, meta=(EditCondition="bThrottleTicks", ClampMin="0.0"))
+	float LowTickInterval = 0.5f;
+
+	UPROPERTY(BlueprintAssignable)
+	FCMOnSignificanceChanged OnSignificanceChanged;
+
+private:
+	/** Records the throttled components and their own tick intervals, done once on the first throttle */
+	void GatherThrottledComponents();
+
+	void ApplyTickInterval();
+
+private:
+	TArray<TWeakObjectPtr<UActorComponent>> ThrottledComponents;
+	TArray<float> OriginalTickIntervals;
+	float OriginalActorTickInterval = 0.f;
+	bool bThrottledComponentsGathered = false;
+
+	int32 RegistryHandle = INDEX_NONE;
+
+	ECMSignificance Significance = ECMSignificance::High;
+};
@@ -1,11 +1,27 @@
 #include "CMSpringArmComponent.h"
 
+#include "CMCameraBudgetGovernor.h"
 #include "CMCameraMode.h"
+#include "CMCameraModeVolume.h"
+#include "CMCameraModeVolumeIndex.h"
+#include "CMCameraSignificanceService.h"
+#include "CMCameraTrack.h"
+#include "CMCameraStats.h"
 #include "DrawDebugHelpers.h"
+#include "Engine/Engine.h"
+#include "Engine/GameInstance.h"
+#include "GameplayTagAssetInterface.h"
 #include "CameraModes/CMPlayerController.h"
+#include "CameraSubsystems/CMCameraSubsystem_Fade.h"
 #include "CameraSubsystems/CMCameraSubsystem_Transform.h"
+#include "ContentStreaming.h"
 #include "UObject/StrongObjectPtr.h"
 
+DECLARE_CYCLE_STAT(TEXT("Spring arm tick"), STAT_CMSpringArmTick, STATGROUP_CameraModes);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Frame arena block allocations"), STAT_CMFrameArenaBlockAllocations, STATGROUP_CameraModes);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Frame arena bytes used"), STAT_CMFrameArenaBytesUsed, STATGROUP_CameraModes);
+DECLARE_CYCLE_STAT(TEXT("Predicted pose"), STAT_CMPredictedPose, STATGROUP_CameraModes);
+
 UCMSpringArmComponent::UCMSpringArmComponent()
 {
 	PrimaryComponentTick.bCanEverTick = true;
@@ -115,6 +131,31 @@ FRotator UCMSpringArmComponent::GetPlayerRotationInput() const
 	return PlayerRotationInput;
 }
 
+FCMCameraQueryBroker& UCMSpringArmComponent::GetQueryBroker()
+{
+	return QueryBroker;
+}
+
+FCMCameraFrameArena& UCMSpringArmComponent::GetFrameArena()
+{
+	return FrameArena;
+}
+
+FCMCameraOutputBuffer& UCMSpringArmComponent::GetOutputBuffer()
+{
+	return OutputBuffer;
+}
+
+UCMCameraBudgetGovernor* UCMSpringArmComponent::GetBudgetGovernor() const
+{
+	return BudgetGovernor;
+}
+
+FCMCameraDebugDrawer& UCMSpringArmComponent::GetDebugDrawer()
+{
+	return DebugDrawer;
+}
+
 APlayerController* UCMSpringArmComponent::GetOwningController() const
 {
 	const auto owningPawn = GetOwner<APawn>();
@@ -126,6 +167,87 @@ void UCMSpringArmComponent::OnControllerRotationInput(FRotator InPlayerInput)
 	PlayerRotationInput = InPlayerInput;
 }
 
+void UCMSpringArmComponent::AddOwnerTag(FGameplayTag Tag)
+{
+	SetOwnerTagCount(Tag, OwnerTagCounts.FindRef(Tag) + 1);
+}
+
+void UCMSpringArmComponent::RemoveOwnerTag(FGameplayTag Tag)
+{
+	SetOwnerTagCount(Tag, OwnerTagCounts.FindRef(Tag) - 1);
+}
+
+void UCMSpringArmComponent::SetOwnerTagCount(const FGameplayTag Tag, int32 NewCount)
+{
+	if(!Tag.IsValid())
+	{
+		return;
+	}
+	
+	const bool bHadTag = OwnerTagCounts.FindRef(Tag) > 0;
+	const bool bHasTag = NewCount > 0;
+
+	if(bHasTag)
+	{
+		OwnerTagCounts.Add(Tag, NewCount);
+	}
+	else
+	{
+		OwnerTagCounts.Remove(Tag);
+	}
+
+	if(bHadTag != bHasTag)
+	{
+		if(bHasTag)
+		{
+			OwnerTags.AddTagFast(Tag);
+		}
+		else
+		{
+			OwnerTags.RemoveTag(Tag);
+		}
+		
+		EvaluateCameraModeRules();
+	}
+}
+
+const FGameplayTagContainer& UCMSpringArmComponent::GetOwnerTags() const
+{
+	return OwnerTags;
+}
+
+void UCMSpringArmComponent::EvaluateCameraModeRules()
+{
+	if(!HasBegunPlay())
+	{
+		return;
+	}
+
+	FGameplayTag cameraModeTag = VolumeCameraModeTag;
+	if(!cameraModeTag.IsValid())
+	{
+		if(CameraModeRuleSet.IsEmpty())
+		{
+			cameraModeTag = VolumeBaseCameraModeTag;
+		}
+		else
+		{
+			const FGameplayTag ruleCameraModeTag = CameraModeRuleSet.Evaluate(OwnerTags);
+			cameraModeTag = ruleCameraModeTag.IsValid() ? ruleCameraModeTag : InitialCameraModeTag;
+		}
+	}
+
+	if(!cameraModeTag.IsValid())
+	{
+		return;
+	}
+
+	if(CurrentCameraMode == nullptr || CurrentCameraMode->CameraModeTag != cameraModeTag)
+	{
+		SetCameraMode(cameraModeTag);
+	}
+}
+
 void UCMSpringArmComponent::OnRegister()
 {
 	Super::OnRegister();
@@ -134,46 +256,568 @@ void UCMSpringArmComponent::OnRegister()
 	//UpdateDesiredArmLocation(false, false, false, 0.f);
 }
 
+void UCMSpringArmComponent::UpdateCameraModeVolumes()
+{
+	if(VolumeIndex == nullptr || (VolumeIndex->IsEmpty() && !VolumeCameraModeTag.IsValid()))
+	{
+		return;
+	}
+
+	const FVector armOrigin = GetComponentLocation();
+	const FIntVector cell = VolumeIndex->GetCellCoord(armOrigin);
+	if(cell != VolumeCell || VolumeIndex->GetVersion() != VolumeIndexVersion)
+	{
+		VolumeCell = cell;
+		VolumeIndexVersion = VolumeIndex->GetVersion();
+		
+		VolumeCandidates.Reset();
+		VolumeIndex->GetCandidates(cell, VolumeCandidates);
+	}
+
+	const ACMCameraModeVolume* bestVolume = nullptr;
+	for(const auto& volumeCandidate : VolumeCandidates)
+	{
+		const auto volume = volumeCandidate.Get();
+		if(volume != nullptr && (bestVolume == nullptr || volume->Priority > bestVolume->Priority) && volume->ContainsPoint(armOrigin))
+		{
+			bestVolume = volume;
+		}
+	}
+
+	const FGameplayTag volumeCameraModeTag = bestVolume != nullptr ? bestVolume->CameraModeTag : FGameplayTag();
+	if(volumeCameraModeTag != VolumeCameraModeTag)
+	{
+		if(!VolumeCameraModeTag.IsValid())
+		{
+			VolumeBaseCameraModeTag = GetCurrentCameraMode()->CameraModeTag;
+		}
+		
+		VolumeCameraModeTag = volumeCameraModeTag;
+		EvaluateCameraModeRules();
+
+		// The base mode is restored, a stale tag would later undo modes set explicitly
+		if(!VolumeCameraModeTag.IsValid())
+		{
+			VolumeBaseCameraModeTag = FGameplayTag();
+		}
+	}
+}
+
 void UCMSpringArmComponent::BeginPlay()
 {
 	Super::BeginPlay();
 
-	if(const auto playerController = Cast<ACMPlayerController>(GetOwningController()))
+	BudgetGovernor = GetWorld()->GetSubsystem<UCMCameraBudgetGovernor>();
+	SignificanceService = GetWorld()->GetSubsystem<UCMCameraSignificanceService>();
+	VolumeIndex = GetWorld()->GetSubsystem<UCMCameraModeVolumeIndex>();
+
+	BindRotationInput();
+
+	if(const auto gameInstance = GetWorld()->GetGameInstance())
 	{
-		playerController->OnRotationInputTickDelegate.AddUObject(this, &UCMSpringArmComponent::OnControllerRotationInput);
+		gameInstance->OnPawnControllerChangedDelegates.AddDynamic(this, &UCMSpringArmComponent::OnPawnControllerChanged);
 	}
 	
-	SetCameraMode(InitialCameraModeTag);
+	RefreshActivation();
+
+	if(bRecordPoseHistory)
+	{
+		PoseHistory.Configure(PoseHistoryDuration, PoseHistorySampleRate);
+	}
+	
+	CameraModeRuleSet.Compile(CameraModeRules);
+
+	if(const auto tagAssetInterface = Cast<IGameplayTagAssetInterface>(GetOwner()))
+	{
+		FGameplayTagContainer ownedTags;
+		tagAssetInterface->GetOwnedGameplayTags(ownedTags);
+		
+		for(const auto& ownedTag : ownedTags)
+		{
+			OwnerTagCounts.Add(ownedTag, 1);
+		}
+		OwnerTags.AppendTags(ownedTags);
+	}
+
+	// The first mode comes from the rules when they match, either way it is entered without interpolation
+	EvaluateCameraModeRules();
+	if(CurrentCameraMode == nullptr)
+	{
+		SetCameraMode(InitialCameraModeTag);
+	}
 }
 
-void UCMSpringArmComponent::TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+void UCMSpringArmComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
-	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+	if(const auto gameInstance = GetWorld()->GetGameInstance())
+	{
+		gameInstance->OnPawnControllerChangedDelegates.RemoveDynamic(this, &UCMSpringArmComponent::OnPawnControllerChanged);
+	}
+
+	if(const auto rotationInputController = RotationInputController.Get())
+	{
+		rotationInputController->OnRotationInputTickDelegate.RemoveAll(this);
+	}
+	
+	Super::EndPlay(EndPlayReason);
+}
+
+void UCMSpringArmComponent::RefreshActivation()
+{
+	if(ActivationPolicy == ECMCameraActivationPolicy::Dormant || GetOwningController() == nullptr)
+	{
+		CameraEvaluation = ECMCameraEvaluation::Dormant;
+	}
+	else if(IsLocalViewTarget())
+	{
+		CameraEvaluation = ECMCameraEvaluation::Full;
+	}
+	else
+	{
+		CameraEvaluation = ActivationPolicy == ECMCameraActivationPolicy::ServerApproximation ? ECMCameraEvaluation::PoseOnly : ECMCameraEvaluation::Dormant;
+	}
+
+	SetComponentTickEnabled(CameraEvaluation != ECMCameraEvaluation::Dormant);
+}
+
+ECMCameraEvaluation UCMSpringArmComponent::GetCameraEvaluation() const
+{
+	return CameraEvaluation;
+}
 
-	if(const auto playerController = GetOwningController())
+bool UCMSpringArmComponent::SamplePoseHistory(float Time, FTransform& OutCameraTransform, float& OutFOV, FGameplayTag& OutCameraModeTag) const
+{
+	FCMCameraPose cameraPose;
+	if(!PoseHistory.SamplePose(Time, cameraPose))
+	{
+		return false;
+	}
+
+	OutCameraTransform = FTransform(cameraPose.Rotation, cameraPose.Location);
+	OutFOV = cameraPose.FOV;
+	OutCameraModeTag = cameraPose.CameraModeTag;
+	return true;
+}
+
+const FCMCameraPoseHistory& UCMSpringArmComponent::GetPoseHistory() const
+{
+	return PoseHistory;
+}
+
+void UCMSpringArmComponent::PlayCameraTrack(UCMCameraTrack* Track, float StartTime)
+{
+	if(Track == nullptr)
+	{
+		StopCameraTrack();
+		return;
+	}
+	
+	CameraTrack = Track;
+	CameraTrackTime = FMath::Clamp(StartTime, 0.f, Track->Duration);
+
+	FTransform cameraTransform;
+	float fov;
+	CameraTrack->Sample(CameraTrackTime, cameraTransform, fov);
+	CameraTrackSocketTransform = cameraTransform.GetRelativeTransform(GetComponentTransform());
+
+	if(const auto fadeSubsystem = GetCameraSubsystem<UCMCameraSubsystem_Fade>())
+	{
+		fadeSubsystem->SetScriptedOcclusion(true);
+	}
+
+	// Seeking replays everything before StartTime, so actors faded at that point of the track are faded
+	ApplyCameraTrackFadeEvents(0.f, CameraTrackTime);
+}
+
+void UCMSpringArmComponent::StopCameraTrack()
+{
+	CameraTrack = nullptr;
+	
+	if(const auto fadeSubsystem = GetCameraSubsystem<UCMCameraSubsystem_Fade>())
+	{
+		fadeSubsystem->SetScriptedOcclusion(false);
+	}
+}
+
+bool UCMSpringArmComponent::IsPlayingCameraTrack() const
+{
+	return CameraTrack != nullptr;
+}
+
+void UCMSpringArmComponent::SetAsyncProbesSuspended(bool bSuspended)
+{
+	bAsyncProbesSuspended = bSuspended;
+}
+
+bool UCMSpringArmComponent::AreAsyncProbesSuspended() const
+{
+	return bAsyncProbesSuspended;
+}
+
+void UCMSpringArmComponent::UpdatePredictedPose(APlayerController* PlayerController, float DeltaTime)
+{
+	TimeSincePredictedPose += DeltaTime;
+	if(TimeSincePredictedPose < PredictionUpdateInterval)
+	{
+		return;
+	}
+	TimeSincePredictedPose = 0.f;
+
+	SCOPE_CYCLE_COUNTER(STAT_CMPredictedPose);
+
+	FCMCameraPosePrediction prediction;
+	if(CameraTrack != nullptr)
+	{
+		FTransform cameraTransform;
+		CameraTrack->Sample(CameraTrackTime + PredictionLookAhead, cameraTransform, prediction.FOV);
+		prediction.Location = cameraTransform.GetLocation();
+		prediction.Rotation = cameraTransform.Rotator();
+	}
+	else
 	{
+		prediction.Location = GetCameraLocation();
+		prediction.Rotation = GetCameraRotation();
+		prediction.FOV = PlayerController->PlayerCameraManager != nullptr ? PlayerController->PlayerCameraManager->GetFOVAngle() : prediction.FOV;
+
 		for(const auto subsystem : CameraSubsystems)
 		{
 			if(subsystem != nullptr && subsystem->GetSubsystemSettings() != nullptr)
+			{
+				subsystem->PredictPose(PredictionLookAhead, prediction);
+			}
+		}
+	}
+
+	int32 viewportSizeX, viewportSizeY;
+	PlayerController->GetViewportSize(viewportSizeX, viewportSizeY);
+	const float screenSize = FMath::Max(viewportSizeX, 1);
+	const float fovScreenSize = screenSize / FMath::Tan(FMath::DegreesToRadians(FMath::Clamp(prediction.FOV, 1.f, 170.f) * 0.5f));
+
+	// Kept until the next prediction replaces it, the current view keeps being added by the viewport as usual
+	IStreamingManager::Get().AddViewInformation(prediction.Location, screenSize, fovScreenSize, 1.f, false, PredictionUpdateInterval);
+}
+
+void UCMSpringArmComponent::PublishSignificanceView(APlayerController* PlayerController)
+{
+	const auto cameraTransform = GetSocketTransform(NAME_None, RTS_World);
+	const auto cameraManager = PlayerController->PlayerCameraManager;
+	const float fov = cameraManager != nullptr ? cameraManager->GetFOVAngle() : 90.f;
+
+	int32 viewportSizeX, viewportSizeY;
+	PlayerController->GetViewportSize(viewportSizeX, viewportSizeY);
+	const float aspectRatio = viewportSizeY > 0 ? (float)viewportSizeX / viewportSizeY : 16.f / 9.f;
+
+	TCMFrameArray<AActor*> occluders;
+	if(const auto fadeSubsystem = GetCameraSubsystem<UCMCameraSubsystem_Fade>())
+	{
+		fadeSubsystem->GetOccluders(occluders);
+	}
+
+	SignificanceService->PublishView(cameraTransform.GetLocation(), cameraTransform.Rotator(), fov, aspectRatio, occluders);
+}
+
+void UCMSpringArmComponent::TickCameraTrack(float DeltaTime)
+{
+	const float previousTime = CameraTrackTime;
+	CameraTrackTime = FMath::Min(CameraTrackTime + DeltaTime, CameraTrack->Duration);
+	const bool bFinished = CameraTrackTime >= CameraTrack->Duration;
+
+	FTransform cameraTransform;
+	float fov;
+	CameraTrack->Sample(CameraTrackTime, cameraTransform, fov);
+	CameraTrackSocketTransform = cameraTransform.GetRelativeTransform(GetComponentTransform());
+	OutputBuffer.SetFOV(fov);
+
+	// Events on the last key are inside the track too
+	ApplyCameraTrackFadeEvents(previousTime, bFinished ? MAX_flt : CameraTrackTime);
+
+	if(const auto fadeSubsystem = GetCameraSubsystem<UCMCameraSubsystem_Fade>())
+	{
+		if(fadeSubsystem->GetSubsystemSettings() != nullptr)
+		{
+			fadeSubsystem->Tick(DeltaTime);
+		}
+	}
+
+	if(bFinished)
+	{
+		StopCameraTrack();
+	}
+}
+
+void UCMSpringArmComponent::ApplyCameraTrackFadeEvents(float FromTime, float ToTime)
+{
+	const auto fadeSubsystem = GetCameraSubsystem<UCMCameraSubsystem_Fade>();
+	if(fadeSubsystem == nullptr)
+	{
+		return;
+	}
+
+	int32 firstFadeEvent, endFadeEvent;
+	CameraTrack->GetFadeEventRange(FromTime, ToTime, firstFadeEvent, endFadeEvent);
+	for(int32 index = firstFadeEvent; index < endFadeEvent; ++index)
+	{
+		const auto& fadeEvent = CameraTrack->FadeEvents[index];
+		fadeSubsystem->SetOccluding(fadeEvent.ResolveActor(GetWorld()), fadeEvent.bOccluding);
+	}
+}
+
+void UCMSpringArmComponent::RefreshActivationOf(AActor* Actor)
+{
+	if(Actor != nullptr)
+	{
+		if(const auto springArm = Actor->FindComponentByClass<UCMSpringArmComponent>())
+		{
+			if(springArm->HasBegunPlay())
+			{
+				springArm->RefreshActivation();
+			}
+		}
+	}
+}
+
+bool UCMSpringArmComponent::IsLocalViewTarget() const
+{
+	const auto owningPawn = GetOwner<APawn>();
+	if(owningPawn != nullptr && owningPawn->IsLocallyControlled())
+	{
+		return true;
+	}
+
+	for(auto iterator = GetWorld()->GetPlayerControllerIterator(); iterator; ++iterator)
+	{
+		const auto playerController = iterator->Get();
+		if(playerController != nullptr && playerController->IsLocalController() && playerController->GetViewTarget() == GetOwner())
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void UCMSpringArmComponent::OnPawnControllerChanged(APawn* Pawn, AController* Controller)
+{
+	if(Pawn == GetOwner())
+	{
+		BindRotationInput();
+		RefreshActivation();
+	}
+}
+
+void UCMSpringArmComponent::BindRotationInput()
+{
+	const auto playerController = Cast<ACMPlayerController>(GetOwningController());
+	if(playerController == RotationInputController.Get())
+	{
+		return;
+	}
+
+	if(const auto rotationInputController = RotationInputController.Get())
+	{
+		rotationInputController->OnRotationInputTickDelegate.RemoveAll(this);
+	}
+	
+	RotationInputController = playerController;
+	
+	if(playerController != nullptr)
+	{
+		playerController->OnRotationInputTickDelegate.AddUObject(this, &UCMSpringArmComponent::OnControllerRotationInput);
+	}
+}
+
+void UCMSpringArmComponent::TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	SCOPE_CYCLE_COUNTER(STAT_CMSpringArmTick);
+
+	const double tickStartTime = FPlatformTime::Seconds();
+
+	FrameArena.Reset();
+	FCMCameraFrameArena::FScope frameArenaScope(FrameArena);
+
+	const auto playerController = GetOwningController();
+	if(playerController != nullptr && CameraEvaluation != ECMCameraEvaluation::Dormant)
+	{
+		UpdateCameraModeVolumes();
+		
+		if(CameraTrack != nullptr)
+		{
+			TickCameraTrack(DeltaTime);
+		}
+		else if(bUseFixedRateSimulation)
+		{
+			TickFixedRate(DeltaTime);
+		}
+		else
+		{
+			bHasSimulatedPose = false;
+			TickSubsystems(DeltaTime);
+		}
+
+		// Nobody looks through a pose only camera, its writes would only fight the owning client
+		if(CameraEvaluation == ECMCameraEvaluation::Full)
+		{
+			OutputBuffer.Apply(playerController, playerController->PlayerCameraManager);
+
+			if(bPublishPredictedPose)
+			{
+				UpdatePredictedPose(playerController, DeltaTime);
+			}
+
+			if(bPublishSignificanceView && SignificanceService != nullptr)
+			{
+				PublishSignificanceView(playerController);
+			}
+		}
+		else
+		{
+			OutputBuffer.Reset();
+		}
+		
+		UpdateChildTransforms();
+
+		if(bRecordPoseHistory && CameraEvaluation == ECMCameraEvaluation::Full)
+		{
+			const auto cameraTransform = GetSocketTransform(NAME_None, RTS_World);
+			
+			FCMCameraPose cameraPose;
+			cameraPose.Location = cameraTransform.GetLocation();
+			cameraPose.Rotation = cameraTransform.Rotator();
+			cameraPose.FOV = playerController->PlayerCameraManager != nullptr ? playerController->PlayerCameraManager->GetFOVAngle() : cameraPose.FOV;
+			cameraPose.CameraModeTag = GetCurrentCameraMode()->CameraModeTag;
+			
+			PoseHistory.Record(GetWorld()->GetTimeSeconds(), cameraPose);
+		}
+	}
+
+#if CM_CAMERA_DEBUG
+	if(FCMCameraDebugDrawer::IsEnabled(ECMCameraDebugFlags::Modes))
+	{
+		DrawDebugCameraModes();
+	}
+	DebugDrawer.Flush(GetWorld());
+#endif
+
+	if(BudgetGovernor != nullptr)
+	{
+		BudgetGovernor->ReportArmCost(FPlatformTime::Seconds() - tickStartTime);
+	}
+
+	INC_DWORD_STAT_BY(STAT_CMFrameArenaBlockAllocations, FrameArena.GetNumBlockAllocations());
+	INC_DWORD_STAT_BY(STAT_CMFrameArenaBytesUsed, FrameArena.GetBytesUsed());
+}
+
+void UCMSpringArmComponent::TickSubsystems(float DeltaTime)
+{
+	TGuardValue<bool> simulatingGuard(bIsSimulating, true);
+
+	QueryBroker.BeginFrame(GetWorld(), GetOwner());
+	
+	for(const auto subsystem : CameraSubsystems)
+	{
+		if(subsystem != nullptr && subsystem->GetSubsystemSettings() != nullptr)
+		{
+			if(CameraEvaluation == ECMCameraEvaluation::Full || subsystem->IsPoseSubsystem())
 			{
 				subsystem->Tick(DeltaTime);
 			}
 		}
 	}
+}
+
+void UCMSpringArmComponent::TickFixedRate(float DeltaTime)
+{
+	const float stepTime = 1.f / FMath::Max(FixedSimulationRate, 1.f);
+
+	SimulationAccumulator += DeltaTime;
+
+	int32 numSteps = 0;
+	while(SimulationAccumulator >= stepTime && numSteps < MaxSimulationStepsPerFrame)
+	{
+		SimulationAccumulator -= stepTime;
+		++numSteps;
+
+		TickSubsystems(stepTime);
+
+		PreviousSimulatedSocketTransform = bHasSimulatedPose ? CurrentSimulatedSocketTransform : GetSimulatedSocketTransform();
+		CurrentSimulatedSocketTransform = GetSimulatedSocketTransform();
+		bHasSimulatedPose = true;
+	}
+
+	// Frame hitch, drop the time we could not simulate instead of spiralling
+	SimulationAccumulator = FMath::Min(SimulationAccumulator, stepTime);
+	SimulationAlpha = SimulationAccumulator / stepTime;
+}
+
+void UCMSpringArmComponent::DrawDebugCameraModes() const
+{
+	if(GEngine == nullptr)
+	{
+		return;
+	}
+	
+	FString debugText = FString::Printf(TEXT("%s: %s"), *GetOwner()->GetName(), *GetCurrentCameraMode()->CameraModeTag.ToString());
+	for(const auto subsystem : CameraSubsystems)
+	{
+		if(subsystem != nullptr && subsystem->GetSubsystemSettings() != nullptr)
+		{
+			debugText += TEXT("\n  ") + subsystem->GetDebugDescription();
+		}
+	}
 	
-	UpdateChildTransforms();
+	GEngine->AddOnScreenDebugMessage((uint64)GetUniqueID(), 0.f, FColor::Cyan, debugText);
+}
+
+FTransform UCMSpringArmComponent::GetSimulatedSocketTransform() const
+{
+	const auto transformSubsystem = GetCameraSubsystem<UCMCameraSubsystem_Transform>();
+	return transformSubsystem != nullptr ? transformSubsystem->GetSocketTransform(NAME_None, RTS_Component) : FTransform::Identity;
 }
 
 FTransform UCMSpringArmComponent::GetSocketTransform(FName InSocketName, ERelativeTransformSpace TransformSpace) const
 {
+	if(CameraTrack != nullptr)
+	{
+		return MakeSocketTransform(CameraTrackSocketTransform, TransformSpace);
+	}
+	
 	const auto transformSubsystem = GetCameraSubsystem<UCMCameraSubsystem_Transform>();
 	if(transformSubsystem == nullptr)
 	{
 		return GetOwner()->GetTransform();
 	}
+
+	// Subsystems see the latest simulated state, everybody else the interpolated one
+	if(bUseFixedRateSimulation && bHasSimulatedPose && !bIsSimulating)
+	{
+		FTransform relativeTransform;
+		relativeTransform.Blend(PreviousSimulatedSocketTransform, CurrentSimulatedSocketTransform, SimulationAlpha);
+		return MakeSocketTransform(relativeTransform, TransformSpace);
+	}
+	
 	return transformSubsystem->GetSocketTransform(InSocketName, TransformSpace);
 }
 
+FTransform UCMSpringArmComponent::MakeSocketTransform(const FTransform& RelativeTransform, ERelativeTransformSpace TransformSpace) const
+{
+	switch(TransformSpace)
+	{
+		case RTS_World:
+		{
+			return RelativeTransform * GetComponentTransform();
+		}
+		case RTS_Actor:
+		{
+			return (RelativeTransform * GetComponentTransform()).GetRelativeTransform(GetOwner()->GetTransform());
+		}
+		default:
+		{
+			return RelativeTransform;
+		}
+	}
+}
+
 bool UCMSpringArmComponent::HasAnySockets() const
 {
 	return false;
@@ -1,14 +1,45 @@
 #pragma once
 
 #include "GameplayTagContainer.h"
+#include "CMCameraDebug.h"
+#include "CMCameraFrameArena.h"
+#include "CMCameraModeRules.h"
+#include "CMCameraOutputBuffer.h"
+#include "CMCameraPoseHistory.h"
+#include "CMCameraQueryBroker.h"
 #include "CameraSubsystems/CMCameraSubsystem.h"
 #include "Components/SceneComponent.h"
 
 #include "CMSpringArmComponent.generated.h"
 
+class ACMCameraModeVolume;
+class ACMPlayerController;
+class UCMCameraBudgetGovernor;
+class UCMCameraSignificanceService;
+class UCMCameraModeVolumeIndex;
 class UCMCameraMode;
+class UCMCameraTrack;
 class UCMCameraSubsystem;
 
+UENUM()
+enum class ECMCameraActivationPolicy : uint8
+{
+	/** Evaluated only while the owner is the view target of a local player, dormant otherwise */
+	LocalViewTargetOnly,
+	/** Fully evaluated for local view targets, other player controlled owners only get their pose without collision (no Fade, FOV or probe sweeps) */
+	ServerApproximation,
+	/** Never evaluated */
+	Dormant,
+};
+
+UENUM()
+enum class ECMCameraEvaluation : uint8
+{
+	Full,
+	PoseOnly,
+	Dormant,
+};
+
 UCLASS(meta=(BlueprintSpawnableComponent), hideCategories=(Mobility))
 class UCMSpringArmComponent : public USceneComponent
 {
@@ -19,6 +50,7 @@ public:
 	// UActorComponent interface
 	virtual void OnRegister() override;
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	virtual void TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
 	// End of UActorComponent interface
 
@@ -49,8 +81,61 @@ public:
 	}
 
 	FRotator GetPlayerRotationInput() const;
+
+	FCMCameraQueryBroker& GetQueryBroker();
+
+	FCMCameraFrameArena& GetFrameArena();
+
+	FCMCameraOutputBuffer& GetOutputBuffer();
+
+	UCMCameraBudgetGovernor* GetBudgetGovernor() const;
+
+	FCMCameraDebugDrawer& GetDebugDrawer();
 	
 	APlayerController* GetOwningController() const;
+
+	/** Owner tags drive CameraModeRules. Counted, so several sources may add the same tag. */
+	UFUNCTION(BlueprintCallable)
+	void AddOwnerTag(FGameplayTag Tag);
+
+	UFUNCTION(BlueprintCallable)
+	void RemoveOwnerTag(FGameplayTag Tag);
+
+	/** Signature matches tag count change delegates, so it can be bound to them directly */
+	void SetOwnerTagCount(const FGameplayTag Tag, int32 NewCount);
+
+	UFUNCTION(BlueprintPure)
+	const FGameplayTagContainer& GetOwnerTags() const;
+
+	/** Re-evaluates how much of the camera runs and enables or disables the tick accordingly */
+	UFUNCTION(BlueprintCallable)
+	void RefreshActivation();
+
+	ECMCameraEvaluation GetCameraEvaluation() const;
+
+	/** Interpolated camera pose recorded at Time, false when the pose history is disabled or empty */
+	UFUNCTION(BlueprintCallable)
+	bool SamplePoseHistory(float Time, FTransform& OutCameraTransform, float& OutFOV, FGameplayTag& OutCameraModeTag) const;
+
+	const FCMCameraPoseHistory& GetPoseHistory() const;
+
+	/** Plays a baked track instead of evaluating camera subsystems, only fades keep running. Stops at the end of the track. */
+	UFUNCTION(BlueprintCallable)
+	void PlayCameraTrack(UCMCameraTrack* Track, float StartTime = 0.f);
+
+	UFUNCTION(BlueprintCallable)
+	void StopCameraTrack();
+
+	UFUNCTION(BlueprintPure)
+	bool IsPlayingCameraTrack() const;
+
+	/** Async traces only complete when the world ticks, subsystems skip them while the arm is ticked by hand, e.g. by the track baker */
+	void SetAsyncProbesSuspended(bool bSuspended);
+
+	bool AreAsyncProbesSuspended() const;
+
+	/** Refreshes activation of the spring arm on Actor, if it has one */
+	static void RefreshActivationOf(AActor* Actor);
 	
 public:
 	UPROPERTY(EditAnywhere, Category="Camera Modes")
@@ -59,10 +144,90 @@ public:
 	UPROPERTY(EditAnywhere, Category="Camera Modes")
 	FGameplayTag InitialCameraModeTag;
 
+	/**
+	 * Rules selecting the camera mode from the owner tags. Evaluated only when the owner tags change.
+	 * When no rule matches InitialCameraModeTag is used.
+	 */
+	UPROPERTY(EditAnywhere, Category="Camera Modes|Rules")
+	TArray<FCMCameraModeRule> CameraModeRules;
+
+	UPROPERTY(EditAnywhere, Category="Camera Modes|Activation")
+	ECMCameraActivationPolicy ActivationPolicy = ECMCameraActivationPolicy::ServerApproximation;
+
+	/** Keep a compressed history of camera poses, e.g. for kill-cams and rewinds */
+	UPROPERTY(EditAnywhere, Category="Camera Modes|History")
+	bool bRecordPoseHistory = false;
+
+	/** Seconds of poses kept in the history */
+	UPROPERTY(EditAnywhere, Category="Camera Modes|History", meta=(EditCondition="bRecordPoseHistory", ClampMin="0.1", UIMin="0.1"))
+	float PoseHistoryDuration = 5.f;
+
+	/** Poses recorded per second */
+	UPROPERTY(EditAnywhere, Category="Camera Modes|History", meta=(EditCondition="bRecordPoseHistory", ClampMin="1.0", UIMin="1.0", UIMax="120.0"))
+	float PoseHistorySampleRate = 30.f;
+
+	/** Feed the streaming system with the pose the camera is expected to reach, so assets are resident when it gets there */
+	UPROPERTY(EditAnywhere, Category="Camera Modes|Streaming")
+	bool bPublishPredictedPose = false;
+
+	/** Seconds ahead the published pose is predicted */
+	UPROPERTY(EditAnywhere, Category="Camera Modes|Streaming", meta=(EditCondition="bPublishPredictedPose", ClampMin="0.0", UIMin="0.0", UIMax="2.0"))
+	float PredictionLookAhead = 0.5f;
+
+	/** Seconds between published predictions, every prediction stays registered until the next one */
+	UPROPERTY(EditAnywhere, Category="Camera Modes|Streaming", meta=(EditCondition="bPublishPredictedPose", ClampMin="0.05", UIMin="0.05", UIMax="2.0"))
+	float PredictionUpdateInterval = 0.25f;
+
+	/** Publish the camera pose, frustum and faded occluders to UCMCameraSignificanceService every frame */
+	UPROPERTY(EditAnywhere, Category="Camera Modes|Significance")
+	bool bPublishSignificanceView = false;
+
+	/** Advance camera subsystems in fixed steps and publish the pose interpolated between the last two steps */
+	UPROPERTY(EditAnywhere, Category="Camera Modes|Simulation")
+	bool bUseFixedRateSimulation = false;
+
+	/** Steps per second when bUseFixedRateSimulation is enabled */
+	UPROPERTY(EditAnywhere, Category="Camera Modes|Simulation", meta=(EditCondition="bUseFixedRateSimulation", ClampMin="10.0", UIMin="10.0", UIMax="240.0"))
+	float FixedSimulationRate = 60.f;
+
+	/** Upper bound of steps in a single frame, time that does not fit is dropped */
+	UPROPERTY(EditAnywhere, Category="Camera Modes|Simulation", meta=(EditCondition="bUseFixedRateSimulation", ClampMin="1", UIMin="1"))
+	int32 MaxSimulationStepsPerFrame = 4;
+
 private:
 	void SetCameraMode(UCMCameraMode* NewCameraMode);
+
+	void TickSubsystems(float DeltaTime);
+	void TickFixedRate(float DeltaTime);
+
+	FTransform GetSimulatedSocketTransform() const;
+
+	void DrawDebugCameraModes() const;
 	
 	void OnControllerRotationInput(FRotator InPlayerInput);
+
+	void EvaluateCameraModeRules();
+
+	/** Re-fetches volume candidates when the arm origin changed cell, then picks the highest priority volume containing it */
+	void UpdateCameraModeVolumes();
+
+	void TickCameraTrack(float DeltaTime);
+
+	/** Hands the track's fade events with FromTime <= time < ToTime to Fade in order */
+	void ApplyCameraTrackFadeEvents(float FromTime, float ToTime);
+
+	void UpdatePredictedPose(APlayerController* PlayerController, float DeltaTime);
+
+	void PublishSignificanceView(APlayerController* PlayerController);
+
+	FTransform MakeSocketTransform(const FTransform& RelativeTransform, ERelativeTransformSpace TransformSpace) const;
+
+	bool IsLocalViewTarget() const;
+
+	UFUNCTION()
+	void OnPawnControllerChanged(APawn* Pawn, AController* Controller);
+
+	void BindRotationInput();
 	
 private:
 	UPROPERTY(Transient)
@@ -71,5 +236,61 @@ private:
 	UPROPERTY(Transient)
 	TArray<UCMCameraSubsystem*> CameraSubsystems;
 
+	UPROPERTY(Transient)
+	UCMCameraBudgetGovernor* BudgetGovernor;
+
+	UPROPERTY(Transient)
+	UCMCameraSignificanceService* SignificanceService;
+
+	UPROPERTY(Transient)
+	UCMCameraModeVolumeIndex* VolumeIndex;
+
 	FRotator PlayerRotationInput;
+
+	TWeakObjectPtr<ACMPlayerController> RotationInputController;
+
+	ECMCameraEvaluation CameraEvaluation = ECMCameraEvaluation::Full;
+
+	bool bAsyncProbesSuspended = false;
+
+	FCMCameraModeRuleSet CameraModeRuleSet;
+
+	TMap<FGameplayTag, int32> OwnerTagCounts;
+	FGameplayTagContainer OwnerTags;
+
+	FCMCameraQueryBroker QueryBroker;
+
+	FCMCameraFrameArena FrameArena;
+
+	FCMCameraOutputBuffer OutputBuffer;
+
+	FCMCameraDebugDrawer DebugDrawer;
+
+	FCMCameraPoseHistory PoseHistory;
+
+	UPROPERTY(Transient)
+	UCMCameraTrack* CameraTrack = nullptr;
+	
+	float CameraTrackTime = 0.f;
+
+	float TimeSincePredictedPose = MAX_flt;
+	/** Component space pose sampled from the track this frame */
+	FTransform CameraTrackSocketTransform = FTransform::Identity;
+
+	/** Camera mode of the volume the arm origin is in, overrides rules and the base mode */
+	FGameplayTag VolumeCameraModeTag;
+	/** Mode to return to after leaving volumes when there are no rules to evaluate */
+	FGameplayTag VolumeBaseCameraModeTag;
+	
+	TArray<TWeakObjectPtr<ACMCameraModeVolume>> VolumeCandidates;
+	FIntVector VolumeCell = FIntVector(MAX_int32);
+	uint32 VolumeIndexVersion = MAX_uint32;
+
+	/** Fixed rate simulation state, socket transforms are in component space */
+	float SimulationAccumulator = 0.f;
+	float SimulationAlpha = 1.f;
+	FTransform PreviousSimulatedSocketTransform = FTransform::Identity;
+	FTransform CurrentSimulatedSocketTransform = FTransform::Identity;
+	bool bHasSimulatedPose = false;
+	bool bIsSimulating = false;
 };
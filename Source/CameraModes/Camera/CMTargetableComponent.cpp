@@ -0,0 +1,43 @@
+#include "CMTargetableComponent.h"
+
+#include "CMTargetableRegistry.h"
+#include "Engine/World.h"
+
+UCMTargetableComponent::UCMTargetableComponent()
+{
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bStartWithTickEnabled = true;
+}
+
+void UCMTargetableComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	SetComponentTickInterval(RegistrationUpdateInterval);
+
+	if(const auto registry = GetWorld()->GetSubsystem<UCMTargetableRegistry>())
+	{
+		RegistryHandle = registry->RegisterTarget(this);
+	}
+}
+
+void UCMTargetableComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if(const auto registry = GetWorld()->GetSubsystem<UCMTargetableRegistry>())
+	{
+		registry->UnregisterTarget(RegistryHandle);
+	}
+	RegistryHandle = INDEX_NONE;
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void UCMTargetableComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	if(const auto registry = GetWorld()->GetSubsystem<UCMTargetableRegistry>())
+	{
+		registry->UpdateTarget(RegistryHandle);
+	}
+}
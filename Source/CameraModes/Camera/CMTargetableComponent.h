@@ -0,0 +1,35 @@
+#pragma once
+
+#include "Components/SceneComponent.h"
+
+#include "CMTargetableComponent.generated.h"
+
+/**
+ * Point a lock-on camera may frame, place it where the camera should aim, e.g. the chest.
+ * Registers in the world's UCMTargetableRegistry and refreshes its cell every RegistrationUpdateInterval.
+ */
+UCLASS(meta=(BlueprintSpawnableComponent))
+class UCMTargetableComponent : public USceneComponent
+{
+	GENERATED_BODY()
+public:
+	UCMTargetableComponent();
+
+	// UActorComponent interface
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+	// End of UActorComponent interface
+
+public:
+	/** Cleared targets stay registered but are never selected, and a lock on them breaks */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	bool bCanBeTargeted = true;
+
+	/** Seconds between registry cell updates, lock-on queries tolerate targets this far out of date */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, meta=(ClampMin="0.0"))
+	float RegistrationUpdateInterval = 0.25f;
+
+private:
+	int32 RegistryHandle = INDEX_NONE;
+};
@@ -0,0 +1,85 @@
+#include "CMTargetableRegistry.h"
+
+#include "CMTargetableComponent.h"
+
+int32 UCMTargetableRegistry::RegisterTarget(UCMTargetableComponent* Target)
+{
+	if(Target == nullptr)
+	{
+		return INDEX_NONE;
+	}
+
+	const int32 entryIndex = FreeEntries.Num() > 0 ? FreeEntries.Pop(false) : Entries.AddDefaulted();
+
+	auto& entry = Entries[entryIndex];
+	entry.Target = Target;
+	entry.Cell = Grid.GetCellCoord(Target->GetComponentLocation());
+	entry.bInUse = true;
+
+	Grid.FindOrAddCell(entry.Cell).Add(entryIndex);
+
+	return entryIndex;
+}
+
+void UCMTargetableRegistry::UnregisterTarget(int32 Handle)
+{
+	if(Entries.IsValidIndex(Handle) && Entries[Handle].bInUse)
+	{
+		RemoveFromCell(Handle);
+
+		Entries[Handle] = FEntry();
+		FreeEntries.Add(Handle);
+	}
+}
+
+void UCMTargetableRegistry::UpdateTarget(int32 Handle)
+{
+	if(Entries.IsValidIndex(Handle) && Entries[Handle].bInUse)
+	{
+		auto& entry = Entries[Handle];
+		if(const auto target = entry.Target.Get())
+		{
+			const FIntVector cell = Grid.GetCellCoord(target->GetComponentLocation());
+			if(cell != entry.Cell)
+			{
+				RemoveFromCell(Handle);
+				entry.Cell = cell;
+				Grid.FindOrAddCell(cell).Add(Handle);
+			}
+		}
+	}
+}
+
+void UCMTargetableRegistry::GetCellsInSphere(const FVector& Center, float Radius, TArray<FIntVector>& OutCells) const
+{
+	Grid.GetCellCoords(Grid.GetCellCoord(Center - FVector(Radius)), Grid.GetCellCoord(Center + FVector(Radius)), OutCells);
+}
+
+void UCMTargetableRegistry::QueryCell(const FIntVector& Cell, TArray<TWeakObjectPtr<UCMTargetableComponent>>& OutTargets) const
+{
+	if(const auto cell = Grid.FindCell(Cell))
+	{
+		for(const auto entryIndex : *cell)
+		{
+			OutTargets.Add(Entries[entryIndex].Target);
+		}
+	}
+}
+
+int32 UCMTargetableRegistry::GetNumRegistered() const
+{
+	return Entries.Num() - FreeEntries.Num();
+}
+
+void UCMTargetableRegistry::RemoveFromCell(int32 EntryIndex)
+{
+	const FIntVector cellCoord = Entries[EntryIndex].Cell;
+	if(const auto cell = Grid.FindCell(cellCoord))
+	{
+		cell->RemoveSingleSwap(EntryIndex, false);
+		if(cell->Num() == 0)
+		{
+			Grid.RemoveCell(cellCoord);
+		}
+	}
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "CMUniformGrid.h"
+#include "Subsystems/WorldSubsystem.h"
+
+#include "CMTargetableRegistry.generated.h"
+
+class UCMTargetableComponent;
+
+/**
+ * Per-world uniform grid of lock-on targets.
+ * Targets move, so every entry keeps the location it was indexed with and only changes cells when UpdateTarget sees it cross one.
+ */
+UCLASS()
+class UCMTargetableRegistry : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+	struct FEntry
+	{
+	public:
+		TWeakObjectPtr<UCMTargetableComponent> Target;
+		FIntVector Cell = FIntVector::ZeroValue;
+		bool bInUse = false;
+	};
+
+public:
+	int32 RegisterTarget(UCMTargetableComponent* Target);
+	void UnregisterTarget(int32 Handle);
+	void UpdateTarget(int32 Handle);
+
+	/** Appends the occupied cells touching the sphere, callers gather them with QueryCell, possibly over several frames */
+	void GetCellsInSphere(const FVector& Center, float Radius, TArray<FIntVector>& OutCells) const;
+
+	/** Appends targets indexed in Cell, callers filter by the live location */
+	void QueryCell(const FIntVector& Cell, TArray<TWeakObjectPtr<UCMTargetableComponent>>& OutTargets) const;
+
+	int32 GetNumRegistered() const;
+
+public:
+	static constexpr float CellSize = 2000.f;
+
+private:
+	void RemoveFromCell(int32 EntryIndex);
+
+private:
+	TCMUniformGrid<TArray<int32>> Grid = TCMUniformGrid<TArray<int32>>(CellSize);
+
+	TArray<FEntry> Entries;
+	TArray<int32> FreeEntries;
+};
@@ -0,0 +1,121 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Sparse uniform grid of TCell keyed by integer cell coordinates, shared by the per-world registries.
+ * Cells are created on demand and should be removed by the owner once they are empty.
+ * Entries spanning more than MaxCellsPerEntry cells belong in the oversized cell, which every query has to visit.
+ */
+template<typename TCell>
+class TCMUniformGrid
+{
+public:
+	explicit TCMUniformGrid(float InCellSize, int32 InMaxCellsPerEntry = MAX_int32)
+		: CellSize(InCellSize)
+		, MaxCellsPerEntry(InMaxCellsPerEntry)
+	{
+	}
+
+	FIntVector GetCellCoord(const FVector& Location) const
+	{
+		return FIntVector(FMath::FloorToInt(Location.X / CellSize), FMath::FloorToInt(Location.Y / CellSize), FMath::FloorToInt(Location.Z / CellSize));
+	}
+
+	/** True when the inclusive cell range is too large to be stored cell by cell */
+	bool IsOversized(const FIntVector& MinCell, const FIntVector& MaxCell) const
+	{
+		const FIntVector cellSpan = MaxCell - MinCell + FIntVector(1);
+		return (int64)cellSpan.X * cellSpan.Y * cellSpan.Z > MaxCellsPerEntry;
+	}
+
+	TCell* FindCell(const FIntVector& Coord)
+	{
+		return Cells.Find(Coord);
+	}
+
+	const TCell* FindCell(const FIntVector& Coord) const
+	{
+		return Cells.Find(Coord);
+	}
+
+	TCell& FindOrAddCell(const FIntVector& Coord)
+	{
+		return Cells.FindOrAdd(Coord);
+	}
+
+	void RemoveCell(const FIntVector& Coord)
+	{
+		Cells.Remove(Coord);
+	}
+
+	TCell& GetOversizedCell()
+	{
+		return OversizedCell;
+	}
+
+	const TCell& GetOversizedCell() const
+	{
+		return OversizedCell;
+	}
+
+	/** Calls Visitor(const FIntVector&) for every coordinate from MinCell to MaxCell inclusive, whether the cell exists or not */
+	template<typename TVisitor>
+	static void ForEachCellCoord(const FIntVector& MinCell, const FIntVector& MaxCell, TVisitor&& Visitor)
+	{
+		for(int32 x = MinCell.X; x <= MaxCell.X; ++x)
+		{
+			for(int32 y = MinCell.Y; y <= MaxCell.Y; ++y)
+			{
+				for(int32 z = MinCell.Z; z <= MaxCell.Z; ++z)
+				{
+					Visitor(FIntVector(x, y, z));
+				}
+			}
+		}
+	}
+
+	/** Calls Visitor(TCell&) for every existing cell from MinCell to MaxCell inclusive, the oversized cell is not visited */
+	template<typename TVisitor>
+	void ForEachCell(const FIntVector& MinCell, const FIntVector& MaxCell, TVisitor&& Visitor)
+	{
+		ForEachCellCoord(MinCell, MaxCell, [this, &Visitor](const FIntVector& Coord)
+		{
+			if(const auto cell = Cells.Find(Coord))
+			{
+				Visitor(*cell);
+			}
+		});
+	}
+
+	template<typename TVisitor>
+	void ForEachCell(const FIntVector& MinCell, const FIntVector& MaxCell, TVisitor&& Visitor) const
+	{
+		ForEachCellCoord(MinCell, MaxCell, [this, &Visitor](const FIntVector& Coord)
+		{
+			if(const auto cell = Cells.Find(Coord))
+			{
+				Visitor(*cell);
+			}
+		});
+	}
+
+	/** Appends the coordinates of existing cells from MinCell to MaxCell inclusive, e.g. to visit them over several frames */
+	void GetCellCoords(const FIntVector& MinCell, const FIntVector& MaxCell, TArray<FIntVector>& OutCoords) const
+	{
+		ForEachCellCoord(MinCell, MaxCell, [this, &OutCoords](const FIntVector& Coord)
+		{
+			if(Cells.Contains(Coord))
+			{
+				OutCoords.Add(Coord);
+			}
+		});
+	}
+
+private:
+	TMap<FIntVector, TCell> Cells;
+	TCell OversizedCell;
+
+	float CellSize;
+	int32 MaxCellsPerEntry;
+};
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/IConsoleManager.h"
+#include "UObject/UObjectIterator.h"
+
+#if !UE_BUILD_SHIPPING
+/**
+ * Console command running Benchmark on every camera subsystem of type TSubsystem owned by a spring arm in the world.
+ * The optional first argument is the iteration count.
+ */
+template<typename TSubsystem>
+class TCMCameraBenchmarkCommand
+{
+public:
+	using FBenchmark = void (TSubsystem::*)(int32 Iterations);
+
+	TCMCameraBenchmarkCommand(const TCHAR* Name, const TCHAR* Help, FBenchmark Benchmark, int32 DefaultIterations)
+		: Command(Name, Help, FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([Benchmark, DefaultIterations](const TArray<FString>& Args, UWorld* World)
+		{
+			const int32 iterations = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : DefaultIterations;
+			for(TObjectIterator<TSubsystem> iterator; iterator; ++iterator)
+			{
+				if(iterator->GetOwningSpringArm() != nullptr && iterator->GetWorld() == World)
+				{
+					((*iterator)->*Benchmark)(iterations);
+				}
+			}
+		}))
+	{
+	}
+
+private:
+	FAutoConsoleCommandWithWorldAndArgs Command;
+};
+#endif
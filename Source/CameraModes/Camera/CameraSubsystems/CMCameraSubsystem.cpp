@@ -1,5 +1,6 @@
 #include "CMCameraSubsystem.h"
 
+#include "CameraModes/Camera/CMCameraMode.h"
 #include "CameraModes/Camera/CMSpringArmComponent.h"
 
 void UCMCameraSubsystem::Tick(float DeltaTime)
@@ -20,6 +21,24 @@ UCMCameraModeSubsystem_BaseSettings* UCMCameraSubsystem::GetSubsystemSettings()
 	return nullptr;
 }
 
+bool UCMCameraSubsystem::IsPoseSubsystem() const
+{
+	return false;
+}
+
+void UCMCameraSubsystem::PredictPose(float LookAhead, FCMCameraPosePrediction& InOutPrediction) const
+{
+}
+
+void UCMCameraSubsystem::EstimateCost(const FCMCameraCostContext& Context, FCMCameraSubsystemCost& OutCost) const
+{
+}
+
+FString UCMCameraSubsystem::GetDebugDescription() const
+{
+	return GetClass()->GetName();
+}
+
 void UCMCameraSubsystem::SetOwningSpringArm(UCMSpringArmComponent* SpringArm)
 {
 	check(OwningSpringArmComponent == nullptr)
@@ -52,3 +71,31 @@ APlayerCameraManager* UCMCameraSubsystem::GetCameraManager() const
 	const auto controller = GetOwningController();
 	return controller != nullptr ? controller->PlayerCameraManager : nullptr;
 }
+
+FCMCameraFrameArena& UCMCameraSubsystem::GetFrameArena() const
+{
+	return GetOwningSpringArm()->GetFrameArena();
+}
+
+FCMCameraOutputBuffer& UCMCameraSubsystem::GetOutputBuffer() const
+{
+	return GetOwningSpringArm()->GetOutputBuffer();
+}
+
+bool UCMCameraSubsystem::IsQualityReduced(ECMCameraQualityLevel Level) const
+{
+	const auto budgetGovernor = GetOwningSpringArm()->GetBudgetGovernor();
+	return budgetGovernor != nullptr && budgetGovernor->IsQualityReduced(Level);
+}
+
+bool UCMCameraSubsystem::IsInCurrentCameraMode() const
+{
+	for(const auto subsystemTemplate : GetOwningSpringArm()->GetCurrentCameraMode()->CameraSubsystems)
+	{
+		if(subsystemTemplate != nullptr && subsystemTemplate->GetClass() == GetClass())
+		{
+			return true;
+		}
+	}
+	return false;
+}
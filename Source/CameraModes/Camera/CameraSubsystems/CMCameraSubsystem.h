@@ -2,6 +2,7 @@
 
 #include "CoreMinimal.h"
 #include "Engine/DataAsset.h"
+#include "CameraModes/Camera/CMCameraBudgetGovernor.h"
 
 #include "CMCameraSubsystem.generated.h"
 
@@ -10,6 +11,8 @@ class APawn;
 class APlayerController;
 class APlayerCameraManager;
 class UCMSpringArmComponent;
+class FCMCameraFrameArena;
+class FCMCameraOutputBuffer;
 
 struct FCMCameraSubsystemContext
 {
@@ -17,6 +20,40 @@ public:
 	bool bWithInterpolation = true;
 };
 
+/** Camera pose expected some time ahead, refined by every subsystem in mode order */
+struct FCMCameraPosePrediction
+{
+public:
+	FVector Location = FVector::ZeroVector;
+	FRotator Rotation = FRotator::ZeroRotator;
+	float FOV = 90.f;
+};
+
+/** Assumptions used to estimate camera cost without running the game */
+struct FCMCameraCostContext
+{
+public:
+	/** Longest frame the estimate has to hold for, drives worst case lag substeps */
+	float WorstFrameTime = 0.1f;
+	int32 ExpectedOccluders = 4;
+	int32 MeshesPerOccluder = 4;
+};
+
+/** Static per frame cost of a camera subsystem, summed per camera mode by UCMCameraModeCostCommandlet */
+struct FCMCameraSubsystemCost
+{
+public:
+	int32 NumSceneQueries = 0;
+	/** Shapes of the scene queries, e.g. "Sphere 12" */
+	TArray<FString> SceneQueryShapes;
+	/** Worst case lag substeps at FCMCameraCostContext::WorstFrameTime */
+	int32 MaxLagIterations = 0;
+	int32 NumMaterialWrites = 0;
+	int32 NumOutputWrites = 0;
+	/** Frame work whose allocations grow with the scene instead of the settings */
+	bool bAllocationRisk = false;
+};
+
 UCLASS(EditInlineNew, DefaultToInstanced, Abstract)
 class UCMCameraModeSubsystem_BaseSettings : public UDataAsset
 {
@@ -34,6 +71,18 @@ public:
 
 	virtual void SetSubsystemSettings(UCMCameraModeSubsystem_BaseSettings* NewSettings);
 	virtual UCMCameraModeSubsystem_BaseSettings* GetSubsystemSettings() const;
+
+	/** Pose subsystems keep ticking when the spring arm only approximates the camera pose, e.g. for remote players on a server */
+	virtual bool IsPoseSubsystem() const;
+
+	/** Moves the prediction to where the subsystem will have taken the camera LookAhead seconds from now */
+	virtual void PredictPose(float LookAhead, FCMCameraPosePrediction& InOutPrediction) const;
+
+	/** Adds the per frame work the current settings imply, called on mode assets outside of the game */
+	virtual void EstimateCost(const FCMCameraCostContext& Context, FCMCameraSubsystemCost& OutCost) const;
+
+	/** One line shown by CameraModes.Debug, subsystems report how far they are from their mode targets */
+	virtual FString GetDebugDescription() const;
 	
 	void SetOwningSpringArm(UCMSpringArmComponent* SpringArm);
 	UCMSpringArmComponent* GetOwningSpringArm() const;
@@ -44,6 +93,17 @@ public:
 	APlayerController* GetOwningController() const;
 
 	APlayerCameraManager* GetCameraManager() const;
+
+	FCMCameraFrameArena& GetFrameArena() const;
+
+	/** Camera manager and controller writes go through the buffer, the spring arm applies them at the end of its tick */
+	FCMCameraOutputBuffer& GetOutputBuffer() const;
+
+	/** True when the budget governor reduced camera quality to Level or below */
+	bool IsQualityReduced(ECMCameraQualityLevel Level) const;
+
+	/** Subsystems keep ticking after their mode is left, true while the current mode lists this subsystem's class */
+	bool IsInCurrentCameraMode() const;
 	
 private:
 	UPROPERTY()
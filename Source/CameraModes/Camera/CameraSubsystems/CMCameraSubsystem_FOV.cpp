@@ -1,5 +1,7 @@
 #include "CMCameraSubsystem_FOV.h"
 
+#include "CameraModes/Camera/CMSpringArmComponent.h"
+
 UCMCameraSubsystem_FOV::UCMCameraSubsystem_FOV()
 {
 	Settings = CreateDefaultSubobject<UCMCameraModeSubsystem_FOVSettings>("Settings");
@@ -11,7 +13,10 @@ void UCMCameraSubsystem_FOV::Tick(float DeltaTime)
 	
 	if(const auto cameraManager = GetCameraManager())
 	{
-		const float newFOV = FMath::FInterpConstantTo(cameraManager->GetFOVAngle(), Settings->FOV, DeltaTime, Settings->FOVSpeed);
+		float currentFOV = cameraManager->GetFOVAngle();
+		GetOutputBuffer().GetPendingFOV(currentFOV);
+		
+		const float newFOV = FMath::FInterpConstantTo(currentFOV, Settings->FOV, DeltaTime, Settings->FOVSpeed);
 		SetFOV(newFOV);
 	}
 }
@@ -36,10 +41,23 @@ UCMCameraModeSubsystem_BaseSettings* UCMCameraSubsystem_FOV::GetSubsystemSetting
 	return Settings;
 }
 
+void UCMCameraSubsystem_FOV::PredictPose(float LookAhead, FCMCameraPosePrediction& InOutPrediction) const
+{
+	InOutPrediction.FOV = FMath::FInterpConstantTo(InOutPrediction.FOV, Settings->FOV, LookAhead, Settings->FOVSpeed);
+}
+
+void UCMCameraSubsystem_FOV::EstimateCost(const FCMCameraCostContext& Context, FCMCameraSubsystemCost& OutCost) const
+{
+	OutCost.NumOutputWrites += 1;
+}
+
+FString UCMCameraSubsystem_FOV::GetDebugDescription() const
+{
+	const auto cameraManager = GetCameraManager();
+	return FString::Printf(TEXT("FOV %.1f -> %.1f"), cameraManager != nullptr ? cameraManager->GetFOVAngle() : 0.f, Settings->FOV);
+}
+
 void UCMCameraSubsystem_FOV::SetFOV(float NewFOV)
 {
-	if(const auto cameraManager = GetCameraManager())
-	{
-		cameraManager->SetFOV(NewFOV);
-	}
+	GetOutputBuffer().SetFOV(NewFOV);
 }
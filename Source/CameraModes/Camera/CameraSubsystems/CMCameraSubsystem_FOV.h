@@ -29,6 +29,12 @@ public:
 
 	virtual void SetSubsystemSettings(UCMCameraModeSubsystem_BaseSettings* NewSettings) override;
 	virtual UCMCameraModeSubsystem_BaseSettings* GetSubsystemSettings() const override;
+
+	virtual void PredictPose(float LookAhead, FCMCameraPosePrediction& InOutPrediction) const override;
+
+	virtual void EstimateCost(const FCMCameraCostContext& Context, FCMCameraSubsystemCost& OutCost) const override;
+
+	virtual FString GetDebugDescription() const override;
 public:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Instanced)
 	UCMCameraModeSubsystem_FOVSettings* Settings;
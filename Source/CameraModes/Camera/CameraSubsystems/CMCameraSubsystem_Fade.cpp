@@ -1,7 +1,56 @@
 #include "CMCameraSubsystem_Fade.h"
 
+#include "CMCameraBenchmarkCommand.h"
+#include "Async/ParallelFor.h"
+#include "CameraModes/Camera/CMCameraStats.h"
+#include "CameraModes/Camera/CMFadeableRegistry.h"
 #include "CameraModes/Camera/CMSpringArmComponent.h"
-#include "Kismet/KismetSystemLibrary.h"
+#include "EngineUtils.h"
+#include "HAL/PlatformTime.h"
+#include "Materials/MaterialInstanceDynamic.h"
+#include "Materials/MaterialParameterCollection.h"
+#include "Materials/MaterialParameterCollectionInstance.h"
+
+DECLARE_CYCLE_STAT(TEXT("Fade compute"), STAT_CMFadeCompute, STATGROUP_CameraModes);
+DECLARE_CYCLE_STAT(TEXT("Fade apply"), STAT_CMFadeApply, STATGROUP_CameraModes);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Fade actors written"), STAT_CMFadeActorsWritten, STATGROUP_CameraModes);
+
+static TAutoConsoleVariable<int32> CVarCameraFadeParallelMinActors(
+	TEXT("CameraModes.Fade.ParallelMinActors"),
+	64,
+	TEXT("Tracked occluders from which Fade computes progress on worker threads."));
+
+namespace CMFade
+{
+	/** Entries per ParallelFor task, one entry is far cheaper than scheduling a task */
+	constexpr int32 ChunkSize = 64;
+
+	/** AppliedParameterValues of actors that were never written */
+	constexpr float NotApplied = MAX_flt;
+
+	/** Advances Progresses towards their FadeIns target and fills ParameterValues */
+	void ComputeFades(TArrayView<float> Progresses, TArrayView<const bool> FadeIns, TArrayView<float> ParameterValues,
+		float DeltaTime, float FadeSpeed, float ParameterMin, float ParameterMax, bool bForceSingleThread)
+	{
+		const int32 num = Progresses.Num();
+		ParallelFor(FMath::DivideAndRoundUp(num, ChunkSize), [&](int32 ChunkIndex)
+		{
+			const int32 chunkEnd = FMath::Min(num, (ChunkIndex + 1) * ChunkSize);
+			for(int32 index = ChunkIndex * ChunkSize; index < chunkEnd; ++index)
+			{
+				Progresses[index] = FMath::FInterpConstantTo(Progresses[index], FadeIns[index] ? 1.f : 0.f, DeltaTime, FadeSpeed);
+				ParameterValues[index] = FMath::Lerp(ParameterMin, ParameterMax, Progresses[index]);
+			}
+		}, bForceSingleThread);
+	}
+}
+
+#if !UE_BUILD_SHIPPING
+static TCMCameraBenchmarkCommand<UCMCameraSubsystem_Fade> CmdCameraBenchmarkFadeUpdate(
+	TEXT("CameraModes.Benchmark.FadeUpdate"),
+	TEXT("Times the Fade compute and apply steps for 10, 100 and 1000 tracked occluders on every spring arm in the world. Optional argument: iterations (default 1000)."),
+	&UCMCameraSubsystem_Fade::BenchmarkFadeUpdate, 1000);
+#endif
 
 UCMCameraSubsystem_Fade::UCMCameraSubsystem_Fade()
 {
@@ -15,68 +64,593 @@ void UCMCameraSubsystem_Fade::Tick(float DeltaTime)
 	const FVector traceStart = GetOwningSpringArm()->GetCameraLocation();
 	const FVector traceEnd = GetOwningActor()->GetActorLocation();
 
-	const EDrawDebugTrace::Type debugTraceType = EDrawDebugTrace::ForOneFrame;
+	for(int32 index = FadeActors.Num() - 1; index >= 0; --index)
+	{
+		if(!FadeActors[index].IsValid())
+		{
+			RemoveFadeActorAt(index);
+		}
+	}
 
-	TArray<FHitResult> hitResults;
-	UKismetSystemLibrary::BoxTraceMulti(GetWorld(), traceStart, traceEnd, Settings->TraceHalfSize, GetOwningSpringArm()->GetCameraRotation(), UCollisionProfile::Get()->ConvertToTraceType(Settings->TraceChannel), false, {}, debugTraceType, hitResults, false);
+	// Under budget pressure occluders are refreshed less often, fades keep running with the last known set
+	const auto budgetGovernor = GetOwningSpringArm()->GetBudgetGovernor();
+	const int32 fadeTraceInterval = budgetGovernor != nullptr ? budgetGovernor->GetFadeTraceInterval() : 1;
 	
-	FadeActors.RemoveAll([](const FFadeActorData& FadeActorData)
+	// Scripted occlusion keeps the fades running, occluders come from SetOccluding
+	if(bScriptedOcclusion)
 	{
-		return !FadeActorData.Actor.IsValid();
-	});
-	
-	for(auto& fadeActorData : FadeActors)
+		FramesSinceOcclusionTrace = 0;
+	}
+	else if(Settings->OcclusionMode == ECMFadeOcclusionMode::MaterialParameterCollection)
 	{
-		fadeActorData.bFadeIn = false;
+		WriteCutoutParameters(traceStart, traceEnd, Settings->CutoutRadius);
+
+		// Actors faded before switching to the cutout fade back in on their own
+		for(auto& bFadeIn : FadeInFlags)
+		{
+			bFadeIn = false;
+		}
 	}
-	
-	for(const auto& hitResult : hitResults)
+	else if(++FramesSinceOcclusionTrace >= fadeTraceInterval)
 	{
-		if(const auto hitActor = hitResult.GetActor())
+		FramesSinceOcclusionTrace = 0;
+		
+		TCMFrameArray<FVector> traceEnds;
+		traceEnds.Add(traceEnd);
+		for(const auto& focusActors : { &TaggedFocusActors, &AddedFocusActors })
+		{
+			for(const auto& focusActor : *focusActors)
+			{
+				if(focusActor.IsValid() && focusActor.Get() != GetOwningActor())
+				{
+					const FVector focusLocation = focusActor->GetActorLocation();
+					if(FVector::DistSquared(traceStart, focusLocation) <= FMath::Square(Settings->MaxFocusDistance))
+					{
+						traceEnds.Add(focusLocation);
+					}
+				}
+			}
+		}
+
+		TCMFrameArray<AActor*> occluders;
+		GatherOccluders(traceStart, traceEnds, GetOwningSpringArm()->GetCameraRotation().Quaternion(), occluders);
+
+		// Segments end inside the focus targets, they must not fade themselves
+		for(const auto& focusActor : TaggedFocusActors)
+		{
+			occluders.RemoveSingleSwap(focusActor.Get(), false);
+		}
+		for(const auto& focusActor : AddedFocusActors)
 		{
-			auto fadeActorData = FadeActors.FindByPredicate([hitActor](const FFadeActorData& FadeActorData)
+			occluders.RemoveSingleSwap(focusActor.Get(), false);
+		}
+
+		const int32 maxOccluders = budgetGovernor != nullptr ? budgetGovernor->GetMaxOccluders() : MAX_int32;
+		if(occluders.Num() > maxOccluders)
+		{
+			occluders.Sort([&traceStart](const AActor& A, const AActor& B)
 			{
-				return hitActor == FadeActorData.Actor.Get();
+				return FVector::DistSquared(traceStart, A.GetActorLocation()) < FVector::DistSquared(traceStart, B.GetActorLocation());
 			});
+			occluders.SetNum(maxOccluders, false);
+		}
+		
+		for(auto& bFadeIn : FadeInFlags)
+		{
+			bFadeIn = false;
+		}
+		
+		for(const auto occluder : occluders)
+		{
+			FadeInFlags[FindOrAddFadeActor(occluder)] = true;
+		}
+	}
+
+	// Listeners may track further actors through SetOccluding, report before the arrays are handed to the compute step
+	for(int32 index = 0; index < FadeActors.Num(); ++index)
+	{
+		if(FadeInFlags[index] != ReportedFadeInFlags[index])
+		{
+			ReportedFadeInFlags[index] = FadeInFlags[index];
+			OnOccluderChanged.Broadcast(FadeActors[index].Get(), FadeInFlags[index]);
+		}
+	}
 
-			if(fadeActorData == nullptr)
+	{
+		SCOPE_CYCLE_COUNTER(STAT_CMFadeCompute);
+		CMFade::ComputeFades(FadeProgresses, FadeInFlags, ParameterValues, DeltaTime, Settings->FadeSpeed,
+			Settings->MaterialParameterMin, Settings->MaterialParameterMax, FadeActors.Num() < CVarCameraFadeParallelMinActors.GetValueOnGameThread());
+	}
+
+	ApplyFades();
+
+#if CM_CAMERA_DEBUG
+	if(FCMCameraDebugDrawer::IsEnabled(ECMCameraDebugFlags::Occluders))
+	{
+		for(int32 index = 0; index < FadeActors.Num(); ++index)
+		{
+			if(const auto actor = FadeActors[index].Get())
 			{
-				fadeActorData = &FadeActors.AddDefaulted_GetRef();
-				fadeActorData->Actor = hitActor;
-				fadeActorData->FadeProgress = 0.f;
+				FVector boundsOrigin, boundsExtent;
+				actor->GetActorBounds(true, boundsOrigin, boundsExtent);
+				GetOwningSpringArm()->GetDebugDrawer().DrawBox(boundsOrigin, boundsExtent, FQuat::Identity, FLinearColor::LerpUsingHSV(FLinearColor::Green, FLinearColor::Red, FadeProgresses[index]).ToFColor(true));
 			}
-		
-			fadeActorData->bFadeIn = true;
 		}
 	}
+#endif
 
-	for(auto& fadeActorData : FadeActors)
+	// Actors that faded all the way back in stop being tracked, so the arrays only hold what is or was just faded
+	for(int32 index = FadeActors.Num() - 1; index >= 0; --index)
 	{
-		const auto fadeTarget = fadeActorData.bFadeIn ? 1.f : 0.f;
-		
-		fadeActorData.FadeProgress = FMath::FInterpConstantTo(fadeActorData.FadeProgress, fadeTarget, DeltaTime, Settings->FadeSpeed);
+		if(!FadeInFlags[index] && !ReportedFadeInFlags[index] && FadeProgresses[index] == 0.f && AppliedParameterValues[index] == ParameterValues[index])
+		{
+			RemoveFadeActorAt(index);
+		}
+	}
+}
 
-		TArray<UMeshComponent*> meshComponents;
-		fadeActorData.Actor->GetComponents(meshComponents);
+void UCMCameraSubsystem_Fade::ApplyFades()
+{
+	SCOPE_CYCLE_COUNTER(STAT_CMFadeApply);
+
+	int32 numWritten = 0;
+	for(int32 index = 0; index < FadeActors.Num(); ++index)
+	{
+		if(ParameterValues[index] == AppliedParameterValues[index])
+		{
+			continue;
+		}
+
+		const auto actor = FadeActors[index].Get();
+		if(actor == nullptr)
+		{
+			continue;
+		}
+
+		AppliedParameterValues[index] = ParameterValues[index];
+		++numWritten;
 
+		TCMFrameArray<UMeshComponent*> meshComponents;
+		actor->GetComponents(meshComponents);
 		for(const auto meshComponent : meshComponents)
 		{
-			const float materialParameterValue = FMath::Lerp(Settings->MaterialParameterMin, Settings->MaterialParameterMax, fadeActorData.FadeProgress);
-			meshComponent->SetScalarParameterValueOnMaterials(Settings->MaterialParameterName, materialParameterValue);
+			meshComponent->SetScalarParameterValueOnMaterials(Settings->MaterialParameterName, ParameterValues[index]);
+		}
+	}
+
+	INC_DWORD_STAT_BY(STAT_CMFadeActorsWritten, numWritten);
+}
+
+int32 UCMCameraSubsystem_Fade::FindOrAddFadeActor(AActor* Actor)
+{
+	const int32 existingIndex = FadeActors.IndexOfByKey(Actor);
+	if(existingIndex != INDEX_NONE)
+	{
+		return existingIndex;
+	}
+
+	FadeProgresses.Add(0.f);
+	ParameterValues.Add(Settings->MaterialParameterMin);
+	AppliedParameterValues.Add(CMFade::NotApplied);
+	FadeInFlags.Add(true);
+	ReportedFadeInFlags.Add(false);
+	return FadeActors.Add(Actor);
+}
+
+void UCMCameraSubsystem_Fade::RemoveFadeActorAt(int32 Index)
+{
+	FadeActors.RemoveAtSwap(Index, 1, false);
+	FadeProgresses.RemoveAtSwap(Index, 1, false);
+	ParameterValues.RemoveAtSwap(Index, 1, false);
+	AppliedParameterValues.RemoveAtSwap(Index, 1, false);
+	FadeInFlags.RemoveAtSwap(Index, 1, false);
+	ReportedFadeInFlags.RemoveAtSwap(Index, 1, false);
+}
+
+void UCMCameraSubsystem_Fade::SetScriptedOcclusion(bool bScripted)
+{
+	bScriptedOcclusion = bScripted;
+}
+
+void UCMCameraSubsystem_Fade::SetOccluding(AActor* Actor, bool bOccluding)
+{
+	if(Actor != nullptr)
+	{
+		FadeInFlags[FindOrAddFadeActor(Actor)] = bOccluding;
+	}
+}
+
+void UCMCameraSubsystem_Fade::GetOccluders(TCMFrameArray<AActor*>& OutOccluders) const
+{
+	for(int32 index = 0; index < FadeActors.Num(); ++index)
+	{
+		if(FadeInFlags[index] && FadeActors[index].IsValid())
+		{
+			OutOccluders.Add(FadeActors[index].Get());
+		}
+	}
+}
+
+FCMCameraFadeState UCMCameraSubsystem_Fade::SaveFadeState() const
+{
+	FCMCameraFadeState fadeState;
+	fadeState.FadeActors = FadeActors;
+	fadeState.FadeProgresses = FadeProgresses;
+	fadeState.ParameterValues = ParameterValues;
+	fadeState.FadeInFlags = FadeInFlags;
+	fadeState.ReportedFadeInFlags = ReportedFadeInFlags;
+	return fadeState;
+}
+
+void UCMCameraSubsystem_Fade::RestoreFadeState(const FCMCameraFadeState& FadeState)
+{
+	for(int32 index = 0; index < FadeActors.Num(); ++index)
+	{
+		if(!FadeState.FadeActors.Contains(FadeActors[index]))
+		{
+			ParameterValues[index] = Settings->MaterialParameterMin;
+			if(ReportedFadeInFlags[index])
+			{
+				OnOccluderChanged.Broadcast(FadeActors[index].Get(), false);
+			}
 		}
 	}
+	ApplyFades();
+
+	FadeActors = FadeState.FadeActors;
+	FadeProgresses = FadeState.FadeProgresses;
+	ParameterValues = FadeState.ParameterValues;
+	FadeInFlags = FadeState.FadeInFlags;
+	ReportedFadeInFlags = FadeState.ReportedFadeInFlags;
+
+	// Restored actors may have been written since, the saved values go out on the next apply
+	AppliedParameterValues.Init(CMFade::NotApplied, FadeActors.Num());
+}
+
+void UCMCameraSubsystem_Fade::AddFocusActor(AActor* Actor)
+{
+	if(Actor != nullptr)
+	{
+		AddedFocusActors.AddUnique(Actor);
+	}
+}
+
+void UCMCameraSubsystem_Fade::RemoveFocusActor(AActor* Actor)
+{
+	AddedFocusActors.RemoveSingleSwap(Actor, false);
+}
+
+void UCMCameraSubsystem_Fade::ResolveFocusActors()
+{
+	TaggedFocusActors.Reset();
+
+	if(Settings->FocusActorTags.Num() == 0)
+	{
+		return;
+	}
+
+	for(TActorIterator<AActor> iterator(GetWorld()); iterator; ++iterator)
+	{
+		for(const auto& focusActorTag : Settings->FocusActorTags)
+		{
+			if(iterator->ActorHasTag(focusActorTag))
+			{
+				TaggedFocusActors.Add(*iterator);
+				break;
+			}
+		}
+	}
+}
+
+void UCMCameraSubsystem_Fade::GatherOccluders(const FVector& TraceStart, TArrayView<const FVector> TraceEnds, const FQuat& TraceRotation, TCMFrameArray<AActor*>& OutOccluders)
+{
+	if(Settings->OcclusionQuery == ECMFadeOcclusionQuery::FadeableRegistry)
+	{
+		if(const auto registry = GetWorld()->GetSubsystem<UCMFadeableRegistry>())
+		{
+			const FVector traceExtent = FBox(-Settings->TraceHalfSize, Settings->TraceHalfSize).TransformBy(FTransform(TraceRotation)).GetExtent();
+			for(const auto& traceEnd : TraceEnds)
+			{
+				registry->QuerySegment(TraceStart, traceEnd, traceExtent, OutOccluders);
+			}
+		}
+		return;
+	}
+
+	if(OcclusionQueryHandle == INDEX_NONE)
+	{
+		UpdateOcclusionQuery();
+	}
+
+	GetOwningSpringArm()->GetQueryBroker().ResolveFan(OcclusionQueryHandle, TraceStart, TraceEnds, TraceRotation, HitResults);
+
+#if CM_CAMERA_DEBUG
+	if(FCMCameraDebugDrawer::IsEnabled(ECMCameraDebugFlags::Occluders))
+	{
+		auto& debugDrawer = GetOwningSpringArm()->GetDebugDrawer();
+		debugDrawer.DrawBox(TraceStart, Settings->TraceHalfSize, TraceRotation, FColor::Red);
+		for(const auto& traceEnd : TraceEnds)
+		{
+			debugDrawer.DrawBox(traceEnd, Settings->TraceHalfSize, TraceRotation, FColor::Red);
+		}
+		for(const auto& hitResult : HitResults)
+		{
+			debugDrawer.DrawPoint(hitResult.ImpactPoint, 16.f, hitResult.bBlockingHit ? FColor::Red : FColor::Green);
+		}
+	}
+#endif
+
+	for(const auto& hitResult : HitResults)
+	{
+		if(const auto hitActor = hitResult.GetActor())
+		{
+			OutOccluders.AddUnique(hitActor);
+		}
+	}
+}
+
+void UCMCameraSubsystem_Fade::WriteCutoutParameters(const FVector& CameraLocation, const FVector& PawnLocation, float Radius)
+{
+	// A mode with another collection takes over, the previous one must not keep cutting out
+	if(CutoutCollection.Get() != Settings->CutoutParameterCollection || CutoutRadiusName != Settings->CutoutRadiusParameterName)
+	{
+		CollapseCutout();
+		CutoutCollection = Settings->CutoutParameterCollection;
+		CutoutRadiusName = Settings->CutoutRadiusParameterName;
+		bCutoutWritten = false;
+	}
+
+	if(Settings->CutoutParameterCollection == nullptr)
+	{
+		return;
+	}
+
+	const auto collectionInstance = GetWorld()->GetParameterCollectionInstance(Settings->CutoutParameterCollection);
+	if(collectionInstance == nullptr)
+	{
+		return;
+	}
+
+	if(!bCutoutWritten || !CutoutCameraLocation.Equals(CameraLocation))
+	{
+		CutoutCameraLocation = CameraLocation;
+		collectionInstance->SetVectorParameterValue(Settings->CameraLocationParameterName, FLinearColor(CameraLocation));
+	}
+
+	if(!bCutoutWritten || !CutoutPawnLocation.Equals(PawnLocation))
+	{
+		CutoutPawnLocation = PawnLocation;
+		collectionInstance->SetVectorParameterValue(Settings->PawnLocationParameterName, FLinearColor(PawnLocation));
+	}
+
+	if(!bCutoutWritten || CutoutRadius != Radius)
+	{
+		CutoutRadius = Radius;
+		collectionInstance->SetScalarParameterValue(CutoutRadiusName, Radius);
+	}
+
+	bCutoutWritten = true;
+}
+
+void UCMCameraSubsystem_Fade::CollapseCutout()
+{
+	if(!bCutoutWritten || CutoutRadius <= 0.f || !CutoutCollection.IsValid())
+	{
+		return;
+	}
+
+	if(const auto collectionInstance = GetWorld()->GetParameterCollectionInstance(CutoutCollection.Get()))
+	{
+		collectionInstance->SetScalarParameterValue(CutoutRadiusName, 0.f);
+	}
+	CutoutRadius = 0.f;
 }
 
 void UCMCameraSubsystem_Fade::OnEnterToCameraMode(const FCMCameraSubsystemContext& Context)
 {
 	Super::OnEnterToCameraMode(Context);
 
+	UpdateOcclusionQuery();
+	ResolveFocusActors();
+
+	// Collapse the cutout so materials stop cutting out once the mode fades per actor again
+	if(Settings->OcclusionMode == ECMFadeOcclusionMode::PerActor)
+	{
+		CollapseCutout();
+	}
+
 	if(!Context.bWithInterpolation)
 	{
 		
 	}
 }
 
+void UCMCameraSubsystem_Fade::UpdateOcclusionQuery()
+{
+	auto& queryBroker = GetOwningSpringArm()->GetQueryBroker();
+	if(Settings->OcclusionMode == ECMFadeOcclusionMode::PerActor && Settings->OcclusionQuery == ECMFadeOcclusionQuery::Physics)
+	{
+		FCMCameraSceneQuery occlusionQuery;
+		occlusionQuery.Channel = Settings->TraceChannel;
+		occlusionQuery.Shape = FCollisionShape::MakeBox(Settings->TraceHalfSize);
+		occlusionQuery.bMultiHit = true;
+		occlusionQuery.bIgnoreOwner = false;
+
+		OcclusionQueryHandle = queryBroker.SetQuery(OcclusionQueryHandle, occlusionQuery);
+	}
+	else
+	{
+		queryBroker.RemoveQuery(OcclusionQueryHandle);
+		OcclusionQueryHandle = INDEX_NONE;
+	}
+}
+
+void UCMCameraSubsystem_Fade::EstimateCost(const FCMCameraCostContext& Context, FCMCameraSubsystemCost& OutCost) const
+{
+	if(Settings->OcclusionMode == ECMFadeOcclusionMode::MaterialParameterCollection)
+	{
+		OutCost.NumMaterialWrites += Settings->CutoutParameterCollection != nullptr ? 3 : 0;
+		return;
+	}
+
+	if(Settings->OcclusionQuery == ECMFadeOcclusionQuery::Physics)
+	{
+		OutCost.NumSceneQueries += 1;
+		OutCost.SceneQueryShapes.Add(FString::Printf(TEXT("Box %s multi"), *Settings->TraceHalfSize.ToCompactString()));
+	}
+
+	OutCost.NumMaterialWrites += Context.ExpectedOccluders * Context.MeshesPerOccluder;
+	// Faded actors are tracked per occluder, the list grows with the level rather than the settings
+	OutCost.bAllocationRisk = true;
+}
+
+void UCMCameraSubsystem_Fade::BenchmarkFadeUpdate(int32 Iterations)
+{
+	constexpr float deltaTime = 1.f / 60.f;
+	const float fadeSpeed = FMath::Max(Settings->FadeSpeed, KINDA_SMALL_NUMBER);
+
+	// Occluders are actors of the world with meshes, so the apply step pays for the real material writes
+	constexpr int32 maxActors = 1000;
+	TArray<AActor*> meshActors;
+	for(TActorIterator<AActor> iterator(GetWorld()); iterator && meshActors.Num() < maxActors; ++iterator)
+	{
+		if(*iterator != GetOwningActor() && iterator->FindComponentByClass<UMeshComponent>() != nullptr)
+		{
+			meshActors.Add(*iterator);
+		}
+	}
+
+	if(meshActors.Num() == 0)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Fade benchmark needs actors with meshes in the world"));
+		return;
+	}
+
+	// Writing the parameter creates dynamic instances on the meshes, the original materials and values are put back afterwards
+	struct FSavedMeshMaterials
+	{
+	public:
+		TWeakObjectPtr<UMeshComponent> MeshComponent;
+		TArray<UMaterialInterface*> OverrideMaterials;
+		TArray<TPair<UMaterialInstanceDynamic*, float>> ParameterValues;
+	};
+
+	TArray<FSavedMeshMaterials> savedMeshMaterials;
+	for(const auto meshActor : meshActors)
+	{
+		TArray<UMeshComponent*> meshComponents;
+		meshActor->GetComponents(meshComponents);
+		for(const auto meshComponent : meshComponents)
+		{
+			auto& savedMaterials = savedMeshMaterials.AddDefaulted_GetRef();
+			savedMaterials.MeshComponent = meshComponent;
+			savedMaterials.OverrideMaterials = meshComponent->OverrideMaterials;
+			for(const auto overrideMaterial : meshComponent->OverrideMaterials)
+			{
+				float parameterValue;
+				const auto materialInstance = Cast<UMaterialInstanceDynamic>(overrideMaterial);
+				if(materialInstance != nullptr && materialInstance->GetScalarParameterValue(FHashedMaterialParameterInfo(Settings->MaterialParameterName), parameterValue))
+				{
+					savedMaterials.ParameterValues.Emplace(materialInstance, parameterValue);
+				}
+			}
+		}
+	}
+
+	// The tracked occluders are swapped out while the benchmark fills the arrays
+	auto savedFadeActors = MoveTemp(FadeActors);
+	auto savedFadeProgresses = MoveTemp(FadeProgresses);
+	auto savedParameterValues = MoveTemp(ParameterValues);
+	auto savedAppliedParameterValues = MoveTemp(AppliedParameterValues);
+	auto savedFadeInFlags = MoveTemp(FadeInFlags);
+	auto savedReportedFadeInFlags = MoveTemp(ReportedFadeInFlags);
+
+	auto resetOccluders = [this, &meshActors](int32 NumActors)
+	{
+		FadeActors.Reset();
+		FadeProgresses.Reset();
+		ParameterValues.Reset();
+		AppliedParameterValues.Reset();
+		FadeInFlags.Reset();
+		ReportedFadeInFlags.Reset();
+
+		// Half of the occluders fade out and half fade back in, the way they do while the camera moves through a town
+		for(int32 index = 0; index < NumActors; ++index)
+		{
+			const int32 fadeIndex = FindOrAddFadeActor(meshActors[index]);
+			FadeProgresses[fadeIndex] = 0.5f;
+			FadeInFlags[fadeIndex] = index % 2 == 0;
+		}
+	};
+
+	// Mesh lists come from the arm's frame arena, reset every iteration like every tick
+	auto& frameArena = GetOwningSpringArm()->GetFrameArena();
+	FCMCameraFrameArena::FScope frameArenaScope(frameArena);
+
+	for(const int32 numRequested : { 10, 100, 1000 })
+	{
+		const int32 numActors = FMath::Min(numRequested, meshActors.Num());
+		double frameTimes[2];
+
+		for(const bool bForceSingleThread : { true, false })
+		{
+			resetOccluders(numActors);
+
+			const auto startTime = FPlatformTime::Seconds();
+			for(int32 iteration = 0; iteration < Iterations; ++iteration)
+			{
+				frameArena.Reset();
+				CMFade::ComputeFades(FadeProgresses, FadeInFlags, ParameterValues, deltaTime, fadeSpeed, Settings->MaterialParameterMin, Settings->MaterialParameterMax, bForceSingleThread);
+				ApplyFades();
+			}
+			frameTimes[bForceSingleThread ? 0 : 1] = FPlatformTime::Seconds() - startTime;
+		}
+
+		// Writes of one more frame, zero once every fade has settled where every actor used to be written
+		CMFade::ComputeFades(FadeProgresses, FadeInFlags, ParameterValues, deltaTime, fadeSpeed, Settings->MaterialParameterMin, Settings->MaterialParameterMax, true);
+		int32 numWritten = 0;
+		for(int32 index = 0; index < numActors; ++index)
+		{
+			numWritten += ParameterValues[index] != AppliedParameterValues[index] ? 1 : 0;
+		}
+
+		UE_LOG(LogTemp, Display, TEXT("Fade %d occluders: serial %.3f us, parallel %.3f us per frame compute and apply, %d actors written after %d frames"),
+			numActors, frameTimes[0] * 1000000.0 / Iterations, frameTimes[1] * 1000000.0 / Iterations, numWritten, Iterations);
+	}
+
+	for(const auto& savedMaterials : savedMeshMaterials)
+	{
+		const auto meshComponent = savedMaterials.MeshComponent.Get();
+		if(meshComponent == nullptr)
+		{
+			continue;
+		}
+
+		meshComponent->EmptyOverrideMaterials();
+		for(int32 elementIndex = 0; elementIndex < savedMaterials.OverrideMaterials.Num(); ++elementIndex)
+		{
+			meshComponent->SetMaterial(elementIndex, savedMaterials.OverrideMaterials[elementIndex]);
+		}
+		for(const auto& parameterValue : savedMaterials.ParameterValues)
+		{
+			parameterValue.Key->SetScalarParameterValue(Settings->MaterialParameterName, parameterValue.Value);
+		}
+	}
+
+	// The tracked occluders are written again on the next tick
+	FadeActors = MoveTemp(savedFadeActors);
+	FadeProgresses = MoveTemp(savedFadeProgresses);
+	ParameterValues = MoveTemp(savedParameterValues);
+	AppliedParameterValues = MoveTemp(savedAppliedParameterValues);
+	FadeInFlags = MoveTemp(savedFadeInFlags);
+	ReportedFadeInFlags = MoveTemp(savedReportedFadeInFlags);
+
+	for(auto& appliedParameterValue : AppliedParameterValues)
+	{
+		appliedParameterValue = CMFade::NotApplied;
+	}
+}
+
 void UCMCameraSubsystem_Fade::SetSubsystemSettings(UCMCameraModeSubsystem_BaseSettings* NewSettings)
 {
 	Settings = Cast<UCMCameraModeSubsystem_FadeSettings>(NewSettings);
@@ -1,14 +1,53 @@
 #pragma once
 
 #include "CMCameraSubsystem.h"
+#include "CameraModes/Camera/CMCameraFrameArena.h"
 
 #include "CMCameraSubsystem_Fade.generated.h"
 
+class UMaterialParameterCollection;
+
+UENUM()
+enum class ECMFadeOcclusionMode : uint8
+{
+	/** Finds occluders and fades every mesh on them through MaterialParameterName */
+	PerActor,
+	/** Writes camera location, pawn location and cutout radius to CutoutParameterCollection, opted in materials cut themselves out */
+	MaterialParameterCollection
+};
+
+UENUM()
+enum class ECMFadeOcclusionQuery : uint8
+{
+	/** Box trace against the physics scene on TraceChannel */
+	Physics,
+	/** Slab tests against primitives registered by UCMFadeableComponent, no physics queries */
+	FadeableRegistry
+};
+
 UCLASS()
 class UCMCameraModeSubsystem_FadeSettings : public UCMCameraModeSubsystem_BaseSettings
 {
 	GENERATED_BODY()
 public:
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	ECMFadeOcclusionMode OcclusionMode = ECMFadeOcclusionMode::PerActor;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta=(EditCondition="OcclusionMode == ECMFadeOcclusionMode::MaterialParameterCollection"))
+	UMaterialParameterCollection* CutoutParameterCollection = nullptr;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta=(EditCondition="OcclusionMode == ECMFadeOcclusionMode::MaterialParameterCollection"))
+	FName CameraLocationParameterName = "CameraLocation";
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta=(EditCondition="OcclusionMode == ECMFadeOcclusionMode::MaterialParameterCollection"))
+	FName PawnLocationParameterName = "PawnLocation";
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta=(EditCondition="OcclusionMode == ECMFadeOcclusionMode::MaterialParameterCollection"))
+	FName CutoutRadiusParameterName = "CutoutRadius";
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta=(EditCondition="OcclusionMode == ECMFadeOcclusionMode::MaterialParameterCollection"))
+	float CutoutRadius = 150.f;
+	
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	FName MaterialParameterName;
 
@@ -22,10 +61,34 @@ public:
 	float FadeSpeed = 1.f;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	ECMFadeOcclusionQuery OcclusionQuery = ECMFadeOcclusionQuery::Physics;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta=(EditCondition="OcclusionQuery == ECMFadeOcclusionQuery::Physics"))
 	TEnumAsByte<ECollisionChannel> TraceChannel = ECollisionChannel::ECC_Visibility;
 	
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	FVector TraceHalfSize = FVector(1.f, 120.f, 180.f);
+
+	/** Actors with these tags are focus targets next to the owner, e.g. allies. Resolved when the mode is entered. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta=(EditCondition="OcclusionMode == ECMFadeOcclusionMode::PerActor"))
+	TArray<FName> FocusActorTags;
+
+	/** Focus targets further from the camera do not fade their occluders */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta=(EditCondition="OcclusionMode == ECMFadeOcclusionMode::PerActor", ClampMin="0.0"))
+	float MaxFocusDistance = 5000.f;
+};
+
+DECLARE_MULTICAST_DELEGATE_TwoParams(FOnOccluderChangedDelegate, AActor* /*Actor*/, bool /*bOccluding*/);
+
+/** Tracked occluders of UCMCameraSubsystem_Fade, indexed together */
+struct FCMCameraFadeState
+{
+public:
+	TArray<TWeakObjectPtr<AActor>> FadeActors;
+	TArray<float> FadeProgresses;
+	TArray<float> ParameterValues;
+	TArray<bool> FadeInFlags;
+	TArray<bool> ReportedFadeInFlags;
 };
 
 UCLASS()
@@ -33,13 +96,6 @@ class UCMCameraSubsystem_Fade : public UCMCameraSubsystem
 {
 	GENERATED_BODY()
 
-	struct FFadeActorData
-	{
-	public:
-		TWeakObjectPtr<AActor> Actor;
-		float FadeProgress = 0.f;
-		bool bFadeIn = true;
-	};
 public:
 	UCMCameraSubsystem_Fade();
 	
@@ -49,11 +105,91 @@ public:
 
 	virtual void SetSubsystemSettings(UCMCameraModeSubsystem_BaseSettings* NewSettings) override;
 	virtual UCMCameraModeSubsystem_BaseSettings* GetSubsystemSettings() const override;
+
+	/** While scripted, occluders are only set through SetOccluding, no occlusion queries run */
+	void SetScriptedOcclusion(bool bScripted);
+	void SetOccluding(AActor* Actor, bool bOccluding);
+
+	/** Appends the actors currently fading out */
+	void GetOccluders(TCMFrameArray<AActor*>& OutOccluders) const;
+
+	/** Copies the tracked occluders, e.g. before the arm is ticked outside of the game loop */
+	FCMCameraFadeState SaveFadeState() const;
+
+	/** Puts back occluders copied by SaveFadeState, actors tracked only since then are written back to unfaded */
+	void RestoreFadeState(const FCMCameraFadeState& FadeState);
+
+	/** Occluders between the camera and a focus target fade like the ones in front of the owner, e.g. for an objective */
+	UFUNCTION(BlueprintCallable)
+	void AddFocusActor(AActor* Actor);
+
+	UFUNCTION(BlueprintCallable)
+	void RemoveFocusActor(AActor* Actor);
+	
+	virtual void EstimateCost(const FCMCameraCostContext& Context, FCMCameraSubsystemCost& OutCost) const override;
+
+	/** Times compute and apply for 10, 100 and 1000 of the world's mesh actors as occluders, serial and parallel, and counts the material writes of a settled frame. The actors' materials are restored afterwards */
+	void BenchmarkFadeUpdate(int32 Iterations);
 	
 public:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Instanced)
 	UCMCameraModeSubsystem_FadeSettings* Settings;
+
+	/** Broadcast when an actor starts or stops occluding the pawn */
+	FOnOccluderChangedDelegate OnOccluderChanged;
 	
 private:
-	TArray<FFadeActorData> FadeActors;
+	/** Index into the fade arrays */
+	int32 FindOrAddFadeActor(AActor* Actor);
+
+	void RemoveFadeActorAt(int32 Index);
+
+	/** Writes ParameterValues that differ from AppliedParameterValues to the actors' meshes */
+	void ApplyFades();
+
+	/** Collects occluders of every segment from TraceStart to one of TraceEnds into one set */
+	void GatherOccluders(const FVector& TraceStart, TArrayView<const FVector> TraceEnds, const FQuat& TraceRotation, TCMFrameArray<AActor*>& OutOccluders);
+
+	void ResolveFocusActors();
+
+	void UpdateOcclusionQuery();
+
+	/** Writes the cutout capsule to the parameter collection, values that did not change since the last write are skipped */
+	void WriteCutoutParameters(const FVector& CameraLocation, const FVector& PawnLocation, float Radius);
+
+	/** Zeroes the radius in the collection last written, which may not be the one of the current settings */
+	void CollapseCutout();
+
+private:
+	/** Tracked occluders, the arrays below are indexed together */
+	TArray<TWeakObjectPtr<AActor>> FadeActors;
+	TArray<float> FadeProgresses;
+	/** Material parameter value computed this frame and the one last written to the meshes */
+	TArray<float> ParameterValues;
+	TArray<float> AppliedParameterValues;
+	/** Whether the actor occludes and whether that was reported through OnOccluderChanged */
+	TArray<bool> FadeInFlags;
+	TArray<bool> ReportedFadeInFlags;
+
+	/** Handle of the occlusion trace in the spring arm query broker */
+	int32 OcclusionQueryHandle = INDEX_NONE;
+
+	int32 FramesSinceOcclusionTrace = 0;
+
+	bool bScriptedOcclusion = false;
+
+	/** Focus targets besides the owner, from FocusActorTags and AddFocusActor */
+	TArray<TWeakObjectPtr<AActor>> TaggedFocusActors;
+	TArray<TWeakObjectPtr<AActor>> AddedFocusActors;
+
+	/** Last values written to the parameter collection */
+	TWeakObjectPtr<UMaterialParameterCollection> CutoutCollection;
+	FName CutoutRadiusName;
+	FVector CutoutCameraLocation = FVector::ZeroVector;
+	FVector CutoutPawnLocation = FVector::ZeroVector;
+	float CutoutRadius = 0.f;
+	bool bCutoutWritten = false;
+
+	/** Kept between frames so the trace does not reallocate */
+	TArray<FHitResult> HitResults;
 };
@@ -0,0 +1,339 @@
+#include "CMCameraSubsystem_LockOn.h"
+
+#include "CMCameraSubsystem_Transform.h"
+#include "CameraModes/Camera/CMCameraStats.h"
+#include "CameraModes/Camera/CMSpringArmComponent.h"
+#include "CameraModes/Camera/CMTargetableComponent.h"
+#include "CameraModes/Camera/CMTargetableRegistry.h"
+#include "Engine/World.h"
+
+DECLARE_CYCLE_STAT(TEXT("Lock-on"), STAT_CMLockOn, STATGROUP_CameraModes);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Lock-on candidates scored"), STAT_CMLockOnCandidatesScored, STATGROUP_CameraModes);
+
+namespace CMLockOn
+{
+	/** Keeps the reciprocal square root finite for candidates at the origin */
+	constexpr float MinDistanceSquared = 1.f;
+}
+
+UCMCameraSubsystem_LockOn::UCMCameraSubsystem_LockOn()
+{
+	Settings = CreateDefaultSubobject<UCMCameraModeSubsystem_LockOnSettings>("Settings");
+}
+
+void UCMCameraSubsystem_LockOn::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	SCOPE_CYCLE_COUNTER(STAT_CMLockOn);
+
+	// Subsystems keep ticking after their mode is left, the lock hands the rotation back once and scoring stops
+	if(!IsInCurrentCameraMode())
+	{
+		if(LockedTarget.IsValid())
+		{
+			ClearLockOn();
+		}
+		if(BestCandidate.IsValid() || Candidates.Num() > 0)
+		{
+			BestCandidate.Reset();
+			ResetCandidates();
+		}
+		return;
+	}
+
+	const FVector origin = GetOwningActor()->GetActorLocation();
+
+	// While async probes are suspended the last line of sight result stands
+	if(!GetOwningSpringArm()->AreAsyncProbesSuspended())
+	{
+		UpdateLineOfSight(GetOwningSpringArm()->GetCameraLocation());
+	}
+
+	if(LockedTarget.IsValid())
+	{
+		const bool bHidden = LineOfSightTarget == LockedTarget && !bLineOfSight;
+		TimeWithoutLineOfSight = bHidden ? TimeWithoutLineOfSight + DeltaTime : 0.f;
+
+		if(IsLockedTargetValid(origin))
+		{
+			UpdateRotationTarget(origin, DeltaTime);
+		}
+		else
+		{
+			ClearLockOn();
+		}
+	}
+	else
+	{
+		if(ScoreCursor >= Candidates.Num() && GatherCursor >= PassCells.Num())
+		{
+			BestCandidate = PassBestCandidate;
+			BeginPass(origin);
+		}
+
+		GatherCandidates(origin, Settings->CandidatesPerFrame);
+
+		const int32 lastCandidate = FMath::Min(ScoreCursor + Settings->CandidatesPerFrame, Candidates.Num());
+		ScoreCandidates(ScoreCursor, lastCandidate, origin, GetOwningSpringArm()->GetCameraRotation().Vector());
+
+		INC_DWORD_STAT_BY(STAT_CMLockOnCandidatesScored, lastCandidate - ScoreCursor);
+		ScoreCursor = lastCandidate;
+	}
+}
+
+void UCMCameraSubsystem_LockOn::SetSubsystemSettings(UCMCameraModeSubsystem_BaseSettings* NewSettings)
+{
+	Settings = Cast<UCMCameraModeSubsystem_LockOnSettings>(NewSettings);
+}
+
+UCMCameraModeSubsystem_BaseSettings* UCMCameraSubsystem_LockOn::GetSubsystemSettings() const
+{
+	return Settings;
+}
+
+void UCMCameraSubsystem_LockOn::EstimateCost(const FCMCameraCostContext& Context, FCMCameraSubsystemCost& OutCost) const
+{
+	// One async line of sight trace in flight
+	OutCost.NumSceneQueries += 1;
+	OutCost.SceneQueryShapes.Add(TEXT("Line"));
+	OutCost.NumOutputWrites += 1;
+}
+
+FString UCMCameraSubsystem_LockOn::GetDebugDescription() const
+{
+	const auto lockedTarget = LockedTarget.Get();
+	return FString::Printf(TEXT("Lock-on %s, %d candidates, line of sight %s"),
+		lockedTarget != nullptr ? *GetNameSafe(lockedTarget->GetOwner()) : TEXT("none"),
+		Candidates.Num(), bLineOfSight ? TEXT("yes") : TEXT("no"));
+}
+
+bool UCMCameraSubsystem_LockOn::LockOn()
+{
+	const auto candidate = BestCandidate.Get();
+	if(candidate == nullptr || !candidate->bCanBeTargeted || !IsInCurrentCameraMode())
+	{
+		return false;
+	}
+
+	// Candidates already known to be hidden are skipped, unknown ones get LoseTargetTime to prove visible
+	if(LineOfSightTarget == BestCandidate && !bLineOfSight)
+	{
+		return false;
+	}
+
+	LockedTarget = candidate;
+	TimeWithoutLineOfSight = 0.f;
+	CurrentRotation = GetOwningSpringArm()->GetCameraRotation();
+
+	return true;
+}
+
+void UCMCameraSubsystem_LockOn::ClearLockOn()
+{
+	LockedTarget.Reset();
+	TimeWithoutLineOfSight = 0.f;
+
+	if(const auto transformSubsystem = GetOwningSpringArm()->GetCameraSubsystem<UCMCameraSubsystem_Transform>())
+	{
+		transformSubsystem->ClearRotationTarget();
+	}
+}
+
+UCMTargetableComponent* UCMCameraSubsystem_LockOn::GetLockedTarget() const
+{
+	return LockedTarget.Get();
+}
+
+void UCMCameraSubsystem_LockOn::ResetCandidates()
+{
+	Candidates.Reset();
+	CandidateX.Reset();
+	CandidateY.Reset();
+	CandidateZ.Reset();
+	PassCells.Reset();
+	ScoreCursor = 0;
+	GatherCursor = 0;
+
+	PassBestCandidate.Reset();
+	PassBestScore = -MAX_flt;
+}
+
+void UCMCameraSubsystem_LockOn::BeginPass(const FVector& Origin)
+{
+	ResetCandidates();
+
+	if(const auto registry = GetWorld()->GetSubsystem<UCMTargetableRegistry>())
+	{
+		registry->GetCellsInSphere(Origin, Settings->SearchRadius, PassCells);
+	}
+}
+
+void UCMCameraSubsystem_LockOn::GatherCandidates(const FVector& Origin, int32 MinUnscored)
+{
+	const auto registry = GetWorld()->GetSubsystem<UCMTargetableRegistry>();
+	if(registry == nullptr)
+	{
+		GatherCursor = PassCells.Num();
+		return;
+	}
+
+	while(GatherCursor < PassCells.Num() && Candidates.Num() - ScoreCursor < MinUnscored)
+	{
+		const int32 firstNew = Candidates.Num();
+		registry->QueryCell(PassCells[GatherCursor++], Candidates);
+
+		for(int32 index = firstNew; index < Candidates.Num(); ++index)
+		{
+			const auto candidate = Candidates[index].Get();
+			const FVector location = candidate != nullptr ? candidate->GetComponentLocation() : Origin;
+			CandidateX.Add(location.X);
+			CandidateY.Add(location.Y);
+			CandidateZ.Add(location.Z);
+		}
+	}
+}
+
+void UCMCameraSubsystem_LockOn::ScoreCandidates(int32 First, int32 Last, const FVector& Origin, const FVector& Forward)
+{
+	const float radiusSquared = FMath::Square(Settings->SearchRadius);
+	const float invRadius = Settings->SearchRadius > 0.f ? 1.f / Settings->SearchRadius : 0.f;
+	const float cosMaxAngle = FMath::Cos(FMath::DegreesToRadians(Settings->MaxAngle));
+
+	auto keepBest = [this](int32 Index, float Score)
+	{
+		if(Score > PassBestScore)
+		{
+			const auto candidate = Candidates[Index].Get();
+			if(candidate != nullptr && candidate->bCanBeTargeted && candidate->GetOwner() != GetOwningActor())
+			{
+				PassBestScore = Score;
+				PassBestCandidate = candidate;
+			}
+		}
+	};
+
+	const VectorRegister originX = VectorSetFloat1(Origin.X);
+	const VectorRegister originY = VectorSetFloat1(Origin.Y);
+	const VectorRegister originZ = VectorSetFloat1(Origin.Z);
+	const VectorRegister forwardX = VectorSetFloat1(Forward.X);
+	const VectorRegister forwardY = VectorSetFloat1(Forward.Y);
+	const VectorRegister forwardZ = VectorSetFloat1(Forward.Z);
+	const VectorRegister radiusSquaredV = VectorSetFloat1(radiusSquared);
+	const VectorRegister invRadiusV = VectorSetFloat1(invRadius);
+	const VectorRegister cosMaxAngleV = VectorSetFloat1(cosMaxAngle);
+	const VectorRegister angleWeight = VectorSetFloat1(Settings->AngleWeight);
+	const VectorRegister distanceWeight = VectorSetFloat1(Settings->DistanceWeight);
+	const VectorRegister minDistanceSquared = VectorSetFloat1(CMLockOn::MinDistanceSquared);
+	const VectorRegister rejectedScore = VectorSetFloat1(-MAX_flt);
+
+	MS_ALIGN(16) float scores[4] GCC_ALIGN(16);
+
+	int32 index = First;
+	for(; index + 4 <= Last; index += 4)
+	{
+		const VectorRegister deltaX = VectorSubtract(VectorLoad(CandidateX.GetData() + index), originX);
+		const VectorRegister deltaY = VectorSubtract(VectorLoad(CandidateY.GetData() + index), originY);
+		const VectorRegister deltaZ = VectorSubtract(VectorLoad(CandidateZ.GetData() + index), originZ);
+
+		const VectorRegister distanceSquared = VectorMultiplyAdd(deltaZ, deltaZ, VectorMultiplyAdd(deltaY, deltaY, VectorMultiply(deltaX, deltaX)));
+		const VectorRegister invDistance = VectorReciprocalSqrt(VectorMax(distanceSquared, minDistanceSquared));
+		const VectorRegister distance = VectorMultiply(distanceSquared, invDistance);
+		const VectorRegister cosAngle = VectorMultiply(VectorMultiplyAdd(deltaZ, forwardZ, VectorMultiplyAdd(deltaY, forwardY, VectorMultiply(deltaX, forwardX))), invDistance);
+
+		const VectorRegister score = VectorMultiplyAdd(cosAngle, angleWeight, VectorMultiply(VectorSubtract(VectorOne(), VectorMultiply(distance, invRadiusV)), distanceWeight));
+		const VectorRegister accepted = VectorBitwiseAnd(VectorCompareLE(distanceSquared, radiusSquaredV), VectorCompareGE(cosAngle, cosMaxAngleV));
+
+		const int32 acceptedMask = VectorMaskBits(accepted);
+		if(acceptedMask != 0)
+		{
+			VectorStoreAligned(VectorSelect(accepted, score, rejectedScore), scores);
+			for(int32 lane = 0; lane < 4; ++lane)
+			{
+				keepBest(index + lane, scores[lane]);
+			}
+		}
+	}
+
+	for(; index < Last; ++index)
+	{
+		const FVector delta = FVector(CandidateX[index], CandidateY[index], CandidateZ[index]) - Origin;
+		const float distanceSquared = delta.SizeSquared();
+		const float invDistance = FMath::InvSqrt(FMath::Max(distanceSquared, CMLockOn::MinDistanceSquared));
+		const float cosAngle = (delta | Forward) * invDistance;
+
+		if(distanceSquared <= radiusSquared && cosAngle >= cosMaxAngle)
+		{
+			keepBest(index, cosAngle * Settings->AngleWeight + (1.f - distanceSquared * invDistance * invRadius) * Settings->DistanceWeight);
+		}
+	}
+}
+
+void UCMCameraSubsystem_LockOn::UpdateLineOfSight(const FVector& ViewLocation)
+{
+	const auto world = GetWorld();
+
+	if(LineOfSightTrace.IsValid())
+	{
+		FTraceDatum traceDatum;
+		if(world->QueryTraceData(LineOfSightTrace, traceDatum))
+		{
+			const auto target = LineOfSightTarget.Get();
+			const AActor* targetActor = target != nullptr ? target->GetOwner() : nullptr;
+
+			bLineOfSight = target != nullptr;
+			for(const auto& hit : traceDatum.OutHits)
+			{
+				if(hit.bBlockingHit && hit.GetActor() != targetActor)
+				{
+					bLineOfSight = false;
+				}
+			}
+
+			LineOfSightTrace = FTraceHandle();
+		}
+		else if(!world->IsTraceHandleValid(LineOfSightTrace, false))
+		{
+			// Result was dropped, e.g. after a hitch, trace again
+			LineOfSightTrace = FTraceHandle();
+		}
+	}
+
+	const auto target = LockedTarget.IsValid() ? LockedTarget.Get() : BestCandidate.Get();
+	if(!LineOfSightTrace.IsValid() && target != nullptr)
+	{
+		if(LineOfSightTarget != target)
+		{
+			bLineOfSight = false;
+		}
+
+		const FCollisionQueryParams queryParams(SCENE_QUERY_STAT(CMCameraLockOnLineOfSight), false, GetOwningActor());
+		LineOfSightTrace = world->AsyncLineTraceByChannel(EAsyncTraceType::Single, ViewLocation, target->GetComponentLocation(), Settings->LineOfSightChannel, queryParams);
+		LineOfSightTarget = target;
+	}
+}
+
+bool UCMCameraSubsystem_LockOn::IsLockedTargetValid(const FVector& Origin) const
+{
+	const auto lockedTarget = LockedTarget.Get();
+	return lockedTarget != nullptr && lockedTarget->bCanBeTargeted
+		&& FVector::DistSquared(lockedTarget->GetComponentLocation(), Origin) <= FMath::Square(Settings->LoseTargetDistance)
+		&& TimeWithoutLineOfSight <= Settings->LoseTargetTime;
+}
+
+void UCMCameraSubsystem_LockOn::UpdateRotationTarget(const FVector& Origin, float DeltaTime)
+{
+	FRotator desiredRotation = (LockedTarget->GetComponentLocation() - Origin).Rotation();
+	desiredRotation.Pitch += Settings->PitchOffset;
+	desiredRotation.Roll = 0.f;
+
+	CurrentRotation = FMath::RInterpTo(CurrentRotation, desiredRotation, DeltaTime, Settings->RotationSpeed);
+
+	if(const auto transformSubsystem = GetOwningSpringArm()->GetCameraSubsystem<UCMCameraSubsystem_Transform>())
+	{
+		transformSubsystem->SetRotationTarget(CurrentRotation);
+	}
+
+	// Keeps the pawn aiming at the target and the camera where it is when the lock ends
+	GetOutputBuffer().SetControlRotation(CurrentRotation);
+}
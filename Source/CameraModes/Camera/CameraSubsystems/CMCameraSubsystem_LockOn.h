@@ -0,0 +1,132 @@
+#pragma once
+
+#include "CMCameraSubsystem.h"
+#include "WorldCollision.h"
+
+#include "CMCameraSubsystem_LockOn.generated.h"
+
+class UCMTargetableComponent;
+
+UCLASS()
+class UCMCameraModeSubsystem_LockOnSettings : public UCMCameraModeSubsystem_BaseSettings
+{
+	GENERATED_BODY()
+public:
+	/** Targets further from the pawn are not candidates */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta=(ClampMin="0.0"))
+	float SearchRadius = 2500.f;
+
+	/** Largest angle between the camera forward and a candidate, in degrees */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta=(ClampMin="0.0", ClampMax="180.0"))
+	float MaxAngle = 60.f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float AngleWeight = 1.f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float DistanceWeight = 0.5f;
+
+	/** Candidates scored per frame, a full pass over the candidates is spread over several frames. Registry cells are gathered only as far as the batch needs. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta=(ClampMin="4"))
+	int32 CandidatesPerFrame = 32;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	TEnumAsByte<ECollisionChannel> LineOfSightChannel = ECollisionChannel::ECC_Visibility;
+
+	/** Seconds the locked target may stay hidden before the lock breaks */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta=(ClampMin="0.0"))
+	float LoseTargetTime = 1.5f;
+
+	/** The lock breaks when the target gets further from the pawn */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta=(ClampMin="0.0"))
+	float LoseTargetDistance = 3500.f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta=(ClampMin="0.0"))
+	float RotationSpeed = 8.f;
+
+	/** Added to the pawn-to-target pitch, negative values look down on the target */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float PitchOffset = -10.f;
+};
+
+/**
+ * Frames a selected target together with the pawn by driving the Transform rotation target and the control rotation.
+ * Candidates are gathered from UCMTargetableRegistry cell by cell and scored in SoA batches of CandidatesPerFrame,
+ * line of sight is one async trace in flight at a time.
+ */
+UCLASS()
+class UCMCameraSubsystem_LockOn : public UCMCameraSubsystem
+{
+	GENERATED_BODY()
+public:
+	UCMCameraSubsystem_LockOn();
+
+	virtual void Tick(float DeltaTime) override;
+
+	virtual void SetSubsystemSettings(UCMCameraModeSubsystem_BaseSettings* NewSettings) override;
+	virtual UCMCameraModeSubsystem_BaseSettings* GetSubsystemSettings() const override;
+
+	virtual void EstimateCost(const FCMCameraCostContext& Context, FCMCameraSubsystemCost& OutCost) const override;
+
+	virtual FString GetDebugDescription() const override;
+
+	/** Locks on the best candidate of the last scoring pass, returns false when there is none */
+	UFUNCTION(BlueprintCallable)
+	bool LockOn();
+
+	UFUNCTION(BlueprintCallable)
+	void ClearLockOn();
+
+	UFUNCTION(BlueprintPure)
+	UCMTargetableComponent* GetLockedTarget() const;
+
+public:
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Instanced)
+	UCMCameraModeSubsystem_LockOnSettings* Settings;
+
+private:
+	/** Drops the candidates and the best one of the current pass */
+	void ResetCandidates();
+
+	/** Starts a scoring pass over the registry cells touching the search sphere */
+	void BeginPass(const FVector& Origin);
+
+	/** Gathers pass cells until MinUnscored candidates wait for scoring or the cells run out */
+	void GatherCandidates(const FVector& Origin, int32 MinUnscored);
+
+	/** Scores candidates [First, Last) and keeps the best of the current pass */
+	void ScoreCandidates(int32 First, int32 Last, const FVector& Origin, const FVector& Forward);
+
+	void UpdateLineOfSight(const FVector& ViewLocation);
+
+	bool IsLockedTargetValid(const FVector& Origin) const;
+
+	void UpdateRotationTarget(const FVector& Origin, float DeltaTime);
+
+private:
+	/** Candidate locations as SoA, captured when the candidates are gathered */
+	TArray<float> CandidateX;
+	TArray<float> CandidateY;
+	TArray<float> CandidateZ;
+	TArray<TWeakObjectPtr<UCMTargetableComponent>> Candidates;
+
+	int32 ScoreCursor = 0;
+
+	/** Registry cells of the current pass, the ones before GatherCursor are in Candidates */
+	TArray<FIntVector> PassCells;
+	int32 GatherCursor = 0;
+
+	TWeakObjectPtr<UCMTargetableComponent> PassBestCandidate;
+	float PassBestScore = -MAX_flt;
+
+	/** Best candidate of the last completed pass */
+	TWeakObjectPtr<UCMTargetableComponent> BestCandidate;
+
+	TWeakObjectPtr<UCMTargetableComponent> LockedTarget;
+	float TimeWithoutLineOfSight = 0.f;
+	FRotator CurrentRotation = FRotator::ZeroRotator;
+
+	FTraceHandle LineOfSightTrace;
+	TWeakObjectPtr<UCMTargetableComponent> LineOfSightTarget;
+	bool bLineOfSight = false;
+};
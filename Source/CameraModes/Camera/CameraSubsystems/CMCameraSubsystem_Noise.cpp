@@ -0,0 +1,195 @@
+#include "CMCameraSubsystem_Noise.h"
+
+#include "CMCameraSubsystem_Transform.h"
+#include "CameraModes/Camera/CMCameraStats.h"
+#include "CameraModes/Camera/CMGradientNoise.h"
+#include "CameraModes/Camera/CMSpringArmComponent.h"
+
+DECLARE_CYCLE_STAT(TEXT("Camera noise"), STAT_CMCameraNoise, STATGROUP_CameraModes);
+
+namespace CMCameraNoise
+{
+	/** Location xyz and pitch, yaw, roll */
+	constexpr int32 NumChannels = 6;
+	constexpr int32 MaxSamples = UCMCameraSubsystem_Noise::MaxLayers * NumChannels;
+	static_assert(MaxSamples % 4 == 0, "Noise batch must be a multiple of the vector width");
+
+	/** Offsets in the noise domain so channels and layers never sample the same curve */
+	constexpr float ChannelSeed = 31.7f;
+	constexpr float LayerSeed = 113.3f;
+}
+
+UCMCameraSubsystem_Noise::UCMCameraSubsystem_Noise()
+{
+	Settings = CreateDefaultSubobject<UCMCameraModeSubsystem_NoiseSettings>("Settings");
+}
+
+void UCMCameraSubsystem_Noise::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	SCOPE_CYCLE_COUNTER(STAT_CMCameraNoise);
+
+	// Subsystems keep ticking after their mode is left, mode layers blend out as on a switch between noise modes
+	if(!IsInCurrentCameraMode())
+	{
+		EndModeLayers(true);
+
+		// Runtime layers play out, after that the zero offset was already handed to Transform
+		if(ActiveLayers.Num() == 0 && LocationOffset.IsZero() && RotationOffset.IsZero())
+		{
+			return;
+		}
+	}
+
+	for(int32 index = ActiveLayers.Num() - 1; index >= 0; --index)
+	{
+		auto& activeLayer = ActiveLayers[index];
+		activeLayer.Age += DeltaTime;
+		activeLayer.Phase = FMath::Fmod(activeLayer.Phase + DeltaTime * activeLayer.Layer.Frequency, (float)FCMGradientNoise::TableSize);
+		if(!activeLayer.bModeLayer && activeLayer.Age >= activeLayer.Layer.Duration)
+		{
+			ActiveLayers.RemoveAtSwap(index, 1, false);
+		}
+	}
+
+	LocationOffset = FVector::ZeroVector;
+	RotationOffset = FRotator::ZeroRotator;
+
+	const int32 numSamples = Align(ActiveLayers.Num() * CMCameraNoise::NumChannels, 4);
+	if(numSamples > 0)
+	{
+		MS_ALIGN(16) float inputs[CMCameraNoise::MaxSamples] GCC_ALIGN(16);
+		MS_ALIGN(16) float outputs[CMCameraNoise::MaxSamples] GCC_ALIGN(16);
+
+		for(int32 layerIndex = 0; layerIndex < ActiveLayers.Num(); ++layerIndex)
+		{
+			const float layerTime = ActiveLayers[layerIndex].Phase + layerIndex * CMCameraNoise::LayerSeed;
+			for(int32 channel = 0; channel < CMCameraNoise::NumChannels; ++channel)
+			{
+				inputs[layerIndex * CMCameraNoise::NumChannels + channel] = layerTime + channel * CMCameraNoise::ChannelSeed;
+			}
+		}
+		for(int32 index = ActiveLayers.Num() * CMCameraNoise::NumChannels; index < numSamples; ++index)
+		{
+			inputs[index] = 0.f;
+		}
+
+		FCMGradientNoise::Evaluate(inputs, outputs, numSamples);
+
+		for(int32 layerIndex = 0; layerIndex < ActiveLayers.Num(); ++layerIndex)
+		{
+			const auto& layer = ActiveLayers[layerIndex].Layer;
+			const float weight = GetLayerWeight(ActiveLayers[layerIndex]) * Settings->AmplitudeScale;
+			const float* noise = outputs + layerIndex * CMCameraNoise::NumChannels;
+
+			LocationOffset += FVector(noise[0], noise[1], noise[2]) * layer.LocationAmplitude * weight;
+			RotationOffset += FRotator(noise[3] * layer.RotationAmplitude.X, noise[4] * layer.RotationAmplitude.Y, noise[5] * layer.RotationAmplitude.Z) * weight;
+		}
+	}
+
+	if(const auto transformSubsystem = GetOwningSpringArm()->GetCameraSubsystem<UCMCameraSubsystem_Transform>())
+	{
+		transformSubsystem->SetAdditiveCameraOffset(LocationOffset, RotationOffset);
+	}
+}
+
+void UCMCameraSubsystem_Noise::OnEnterToCameraMode(const FCMCameraSubsystemContext& Context)
+{
+	Super::OnEnterToCameraMode(Context);
+
+	EndModeLayers(Context.bWithInterpolation);
+
+	for(const auto& layer : Settings->Layers)
+	{
+		if(ActiveLayers.Num() == MaxLayers)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Camera noise: mode has more than %d layers, the rest are ignored"), MaxLayers);
+			break;
+		}
+
+		auto& activeLayer = ActiveLayers.AddDefaulted_GetRef();
+		activeLayer.Layer = layer;
+		activeLayer.bModeLayer = true;
+	}
+}
+
+void UCMCameraSubsystem_Noise::EndModeLayers(bool bBlendOut)
+{
+	for(int32 index = ActiveLayers.Num() - 1; index >= 0; --index)
+	{
+		auto& activeLayer = ActiveLayers[index];
+		if(activeLayer.bModeLayer)
+		{
+			if(bBlendOut)
+			{
+				// Layers of the previous mode blend out instead of cutting
+				activeLayer.bModeLayer = false;
+				activeLayer.Layer.Duration = activeLayer.Age + activeLayer.Layer.BlendOutTime;
+			}
+			else
+			{
+				ActiveLayers.RemoveAtSwap(index, 1, false);
+			}
+		}
+	}
+}
+
+void UCMCameraSubsystem_Noise::SetSubsystemSettings(UCMCameraModeSubsystem_BaseSettings* NewSettings)
+{
+	Settings = Cast<UCMCameraModeSubsystem_NoiseSettings>(NewSettings);
+}
+
+UCMCameraModeSubsystem_BaseSettings* UCMCameraSubsystem_Noise::GetSubsystemSettings() const
+{
+	return Settings;
+}
+
+FString UCMCameraSubsystem_Noise::GetDebugDescription() const
+{
+	return FString::Printf(TEXT("%d/%d layers, offset %s %s"), ActiveLayers.Num(), MaxLayers,
+		*LocationOffset.ToCompactString(), *RotationOffset.ToCompactString());
+}
+
+void UCMCameraSubsystem_Noise::AddNoiseLayer(const FCMCameraNoiseLayer& Layer)
+{
+	if(Layer.Duration <= 0.f)
+	{
+		return;
+	}
+
+	if(ActiveLayers.Num() < MaxLayers)
+	{
+		ActiveLayers.AddDefaulted_GetRef().Layer = Layer;
+		return;
+	}
+
+	int32 weakestIndex = INDEX_NONE;
+	float weakestWeight = MAX_flt;
+	for(int32 index = 0; index < ActiveLayers.Num(); ++index)
+	{
+		const float weight = ActiveLayers[index].bModeLayer ? MAX_flt : GetLayerWeight(ActiveLayers[index]);
+		if(weight < weakestWeight)
+		{
+			weakestWeight = weight;
+			weakestIndex = index;
+		}
+	}
+
+	if(weakestIndex != INDEX_NONE)
+	{
+		ActiveLayers[weakestIndex] = FActiveLayer();
+		ActiveLayers[weakestIndex].Layer = Layer;
+	}
+}
+
+float UCMCameraSubsystem_Noise::GetLayerWeight(const FActiveLayer& ActiveLayer)
+{
+	if(ActiveLayer.bModeLayer)
+	{
+		return 1.f;
+	}
+
+	const float remainingTime = ActiveLayer.Layer.Duration - ActiveLayer.Age;
+	return ActiveLayer.Layer.BlendOutTime > 0.f ? FMath::Clamp(remainingTime / ActiveLayer.Layer.BlendOutTime, 0.f, 1.f) : 1.f;
+}
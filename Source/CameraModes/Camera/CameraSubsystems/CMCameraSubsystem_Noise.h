@@ -0,0 +1,99 @@
+#pragma once
+
+#include "CMCameraSubsystem.h"
+
+#include "CMCameraSubsystem_Noise.generated.h"
+
+USTRUCT(BlueprintType)
+struct FCMCameraNoiseLayer
+{
+	GENERATED_BODY()
+public:
+	/** Camera space location amplitude */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FVector LocationAmplitude = FVector::ZeroVector;
+
+	/** Pitch, yaw and roll amplitude in degrees */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FVector RotationAmplitude = FVector::ZeroVector;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta=(ClampMin="0.0"))
+	float Frequency = 1.f;
+
+	/** Seconds the layer lasts when added with AddNoiseLayer, mode layers last as long as the mode */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta=(ClampMin="0.0"))
+	float Duration = 0.5f;
+
+	/** Seconds before Duration the layer starts fading out */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta=(ClampMin="0.0"))
+	float BlendOutTime = 0.2f;
+};
+
+UCLASS()
+class UCMCameraModeSubsystem_NoiseSettings : public UCMCameraModeSubsystem_BaseSettings
+{
+	GENERATED_BODY()
+public:
+	/** Layers active for the whole mode, e.g. handheld sway */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	TArray<FCMCameraNoiseLayer> Layers;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float AmplitudeScale = 1.f;
+};
+
+/**
+ * Procedural camera noise added on top of the Transform socket.
+ * Mode layers and layers added at runtime are evaluated together as one batch of gradient noise channels,
+ * the number of layers is capped so overlapping impulses do not add cost.
+ */
+UCLASS()
+class UCMCameraSubsystem_Noise : public UCMCameraSubsystem
+{
+	GENERATED_BODY()
+
+	struct FActiveLayer
+	{
+	public:
+		FCMCameraNoiseLayer Layer;
+		float Age = 0.f;
+		/** Noise input advanced by Layer.Frequency, wrapped at the period of the noise so it keeps its precision */
+		float Phase = 0.f;
+		/** Lasts as long as the camera mode instead of Layer.Duration */
+		bool bModeLayer = false;
+	};
+public:
+	UCMCameraSubsystem_Noise();
+
+	virtual void Tick(float DeltaTime) override;
+
+	virtual void OnEnterToCameraMode(const FCMCameraSubsystemContext& Context) override;
+
+	virtual void SetSubsystemSettings(UCMCameraModeSubsystem_BaseSettings* NewSettings) override;
+	virtual UCMCameraModeSubsystem_BaseSettings* GetSubsystemSettings() const override;
+
+	virtual FString GetDebugDescription() const override;
+
+	/** Adds a layer for Layer.Duration seconds, e.g. for an explosion. Replaces the weakest layer when MaxLayers are active. */
+	UFUNCTION(BlueprintCallable)
+	void AddNoiseLayer(const FCMCameraNoiseLayer& Layer);
+
+public:
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Instanced)
+	UCMCameraModeSubsystem_NoiseSettings* Settings;
+
+	/** Mode and runtime layers evaluated per frame, together */
+	static constexpr int32 MaxLayers = 16;
+
+private:
+	/** Turns the mode layers into layers ending after their blend out time, or removes them */
+	void EndModeLayers(bool bBlendOut);
+
+	static float GetLayerWeight(const FActiveLayer& ActiveLayer);
+
+private:
+	TArray<FActiveLayer, TInlineAllocator<MaxLayers>> ActiveLayers;
+
+	FVector LocationOffset = FVector::ZeroVector;
+	FRotator RotationOffset = FRotator::ZeroRotator;
+};
@@ -0,0 +1,298 @@
+#include "CMCameraSubsystem_Rail.h"
+
+#include "CMCameraBenchmarkCommand.h"
+#include "CMCameraSubsystem_Transform.h"
+#include "CameraModes/Camera/CMCameraStats.h"
+#include "CameraModes/Camera/CMSpringArmComponent.h"
+#include "Components/SplineComponent.h"
+#include "EngineUtils.h"
+#include "HAL/PlatformTime.h"
+
+DECLARE_CYCLE_STAT(TEXT("Rail"), STAT_CMRail, STATGROUP_CameraModes);
+
+namespace CMRail
+{
+	/** Sideways distance of the benchmark query points from the rail */
+	constexpr float BenchmarkOffset = 300.f;
+	constexpr int32 BenchmarkQueries = 256;
+}
+
+#if !UE_BUILD_SHIPPING
+static TCMCameraBenchmarkCommand<UCMCameraSubsystem_Rail> CmdCameraBenchmarkRailLookup(
+	TEXT("CameraModes.Benchmark.RailLookup"),
+	TEXT("Times the rail table lookup against USplineComponent::FindInputKeyClosestToWorldLocation on every rail in the world. Optional argument: iterations (default 100)."),
+	&UCMCameraSubsystem_Rail::BenchmarkRailLookup, 100);
+#endif
+
+UCMCameraSubsystem_Rail::UCMCameraSubsystem_Rail()
+{
+	Settings = CreateDefaultSubobject<UCMCameraModeSubsystem_RailSettings>("Settings");
+}
+
+void UCMCameraSubsystem_Rail::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	SCOPE_CYCLE_COUNTER(STAT_CMRail);
+
+	const auto transformSubsystem = GetOwningSpringArm()->GetCameraSubsystem<UCMCameraSubsystem_Transform>();
+	if(transformSubsystem == nullptr)
+	{
+		return;
+	}
+
+	// Modes without Transform do not reset the override on enter, the rail hands it back itself once its mode is left
+	if(!IsInCurrentCameraMode())
+	{
+		if(bRailDistanceValid)
+		{
+			bRailDistanceValid = false;
+			transformSubsystem->ClearCameraOverride();
+		}
+		return;
+	}
+
+	const auto spline = RailSpline.Get();
+	if(spline == nullptr || SampleX.Num() < 2)
+	{
+		transformSubsystem->ClearCameraOverride();
+		return;
+	}
+
+	const FVector pawnLocation = GetOwningActor()->GetActorLocation();
+	const FTransform& splineTransform = spline->GetComponentTransform();
+
+	const float closestDistance = FindClosestDistance(splineTransform.InverseTransformPosition(pawnLocation));
+	CurrentRailDistance = bRailDistanceValid && Settings->RailSpeed > 0.f ? FMath::FInterpTo(CurrentRailDistance, closestDistance, DeltaTime, Settings->RailSpeed) : closestDistance;
+	bRailDistanceValid = true;
+
+	const FVector cameraLocation = splineTransform.TransformPosition(GetLocalLocationAtDistance(CurrentRailDistance)) + Settings->RailOffset;
+	transformSubsystem->SetCameraOverride(cameraLocation, (pawnLocation - cameraLocation).Rotation());
+}
+
+void UCMCameraSubsystem_Rail::OnEnterToCameraMode(const FCMCameraSubsystemContext& Context)
+{
+	Super::OnEnterToCameraMode(Context);
+
+	BuildRailTables();
+}
+
+void UCMCameraSubsystem_Rail::SetSubsystemSettings(UCMCameraModeSubsystem_BaseSettings* NewSettings)
+{
+	Settings = Cast<UCMCameraModeSubsystem_RailSettings>(NewSettings);
+}
+
+UCMCameraModeSubsystem_BaseSettings* UCMCameraSubsystem_Rail::GetSubsystemSettings() const
+{
+	return Settings;
+}
+
+FString UCMCameraSubsystem_Rail::GetDebugDescription() const
+{
+	return FString::Printf(TEXT("Rail %s at %.0f / %.0f, %d samples"), *Settings->RailActorTag.ToString(), CurrentRailDistance, RailLength, SampleX.Num());
+}
+
+void UCMCameraSubsystem_Rail::BenchmarkRailLookup(int32 Iterations)
+{
+	const auto spline = RailSpline.Get();
+	if(spline == nullptr || SampleX.Num() < 2)
+	{
+		return;
+	}
+
+	// Query points walk along the rail beside it, the way a followed pawn does
+	TArray<FVector> queryLocations;
+	queryLocations.Reserve(CMRail::BenchmarkQueries);
+	for(int32 index = 0; index < CMRail::BenchmarkQueries; ++index)
+	{
+		const float distance = RailLength * index / (CMRail::BenchmarkQueries - 1);
+		queryLocations.Add(spline->GetLocationAtDistanceAlongSpline(distance, ESplineCoordinateSpace::World)
+			+ spline->GetRightVectorAtDistanceAlongSpline(distance, ESplineCoordinateSpace::World) * CMRail::BenchmarkOffset);
+	}
+
+	const FTransform& splineTransform = spline->GetComponentTransform();
+	const int32 savedClosestSample = ClosestSample;
+
+	const auto tableStartTime = FPlatformTime::Seconds();
+	for(int32 iteration = 0; iteration < Iterations; ++iteration)
+	{
+		ClosestSample = 0;
+		for(const auto& queryLocation : queryLocations)
+		{
+			FindClosestDistance(splineTransform.InverseTransformPosition(queryLocation));
+		}
+	}
+	const auto tableTime = FPlatformTime::Seconds() - tableStartTime;
+
+	const auto splineStartTime = FPlatformTime::Seconds();
+	for(int32 iteration = 0; iteration < Iterations; ++iteration)
+	{
+		for(const auto& queryLocation : queryLocations)
+		{
+			spline->FindInputKeyClosestToWorldLocation(queryLocation);
+		}
+	}
+	const auto splineTime = FPlatformTime::Seconds() - splineStartTime;
+
+	float maxDifference = 0.f;
+	ClosestSample = 0;
+	for(const auto& queryLocation : queryLocations)
+	{
+		const FVector tableLocation = splineTransform.TransformPosition(GetLocalLocationAtDistance(FindClosestDistance(splineTransform.InverseTransformPosition(queryLocation))));
+		const FVector splineLocation = spline->GetLocationAtSplineInputKey(spline->FindInputKeyClosestToWorldLocation(queryLocation), ESplineCoordinateSpace::World);
+		maxDifference = FMath::Max(maxDifference, FVector::Dist(tableLocation, splineLocation));
+	}
+
+	ClosestSample = savedClosestSample;
+
+	const double numLookups = (double)Iterations * queryLocations.Num();
+	UE_LOG(LogTemp, Display, TEXT("Rail %s, %.0f cm, %d samples: table %.3f us, spline search %.3f us per lookup, max difference %.1f cm"),
+		*Settings->RailActorTag.ToString(), RailLength, SampleX.Num(),
+		tableTime * 1000000.0 / numLookups, splineTime * 1000000.0 / numLookups, maxDifference);
+}
+
+void UCMCameraSubsystem_Rail::BuildRailTables()
+{
+	RailSpline.Reset();
+	SampleX.Reset();
+	SampleY.Reset();
+	SampleZ.Reset();
+	RailLength = 0.f;
+	SampleDistance = 0.f;
+	ClosestSample = 0;
+	bRailDistanceValid = false;
+
+	if(Settings->RailActorTag.IsNone())
+	{
+		return;
+	}
+
+	for(TActorIterator<AActor> iterator(GetWorld()); iterator; ++iterator)
+	{
+		if(iterator->ActorHasTag(Settings->RailActorTag))
+		{
+			if(const auto spline = iterator->FindComponentByClass<USplineComponent>())
+			{
+				RailSpline = spline;
+				break;
+			}
+		}
+	}
+
+	const auto spline = RailSpline.Get();
+	if(spline == nullptr)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Camera rail: no actor tagged %s with a spline component"), *Settings->RailActorTag.ToString());
+		return;
+	}
+
+	RailLength = spline->GetSplineLength();
+
+	const int32 numSamples = FMath::Max(2, FMath::CeilToInt(RailLength / Settings->SampleSpacing) + 1);
+	SampleDistance = RailLength / (numSamples - 1);
+
+	SampleX.Reserve(numSamples);
+	SampleY.Reserve(numSamples);
+	SampleZ.Reserve(numSamples);
+	for(int32 index = 0; index < numSamples; ++index)
+	{
+		const FVector location = spline->GetLocationAtDistanceAlongSpline(index * SampleDistance, ESplineCoordinateSpace::Local);
+		SampleX.Add(location.X);
+		SampleY.Add(location.Y);
+		SampleZ.Add(location.Z);
+	}
+}
+
+float UCMCameraSubsystem_Rail::FindClosestDistance(const FVector& LocalLocation)
+{
+	const int32 numSamples = SampleX.Num();
+
+	int32 sampleIndex = FMath::Clamp(ClosestSample, 0, numSamples - 1);
+	float sampleDistanceSquared = GetSampleDistanceSquared(sampleIndex, LocalLocation);
+
+	// Walk downhill from the previous closest sample
+	int32 step = 0;
+	for(; step < Settings->MaxSearchSteps; ++step)
+	{
+		int32 nextIndex = sampleIndex;
+		float nextDistanceSquared = sampleDistanceSquared;
+
+		if(sampleIndex > 0)
+		{
+			const float distanceSquared = GetSampleDistanceSquared(sampleIndex - 1, LocalLocation);
+			if(distanceSquared < nextDistanceSquared)
+			{
+				nextIndex = sampleIndex - 1;
+				nextDistanceSquared = distanceSquared;
+			}
+		}
+		if(sampleIndex < numSamples - 1)
+		{
+			const float distanceSquared = GetSampleDistanceSquared(sampleIndex + 1, LocalLocation);
+			if(distanceSquared < nextDistanceSquared)
+			{
+				nextIndex = sampleIndex + 1;
+				nextDistanceSquared = distanceSquared;
+			}
+		}
+
+		if(nextIndex == sampleIndex)
+		{
+			break;
+		}
+		sampleIndex = nextIndex;
+		sampleDistanceSquared = nextDistanceSquared;
+	}
+
+	// Still going downhill after MaxSearchSteps, the pawn jumped, scan the whole table once
+	if(step == Settings->MaxSearchSteps)
+	{
+		for(int32 index = 0; index < numSamples; ++index)
+		{
+			const float distanceSquared = GetSampleDistanceSquared(index, LocalLocation);
+			if(distanceSquared < sampleDistanceSquared)
+			{
+				sampleIndex = index;
+				sampleDistanceSquared = distanceSquared;
+			}
+		}
+	}
+
+	ClosestSample = sampleIndex;
+
+	// Refine on the segments either side of the closest sample
+	float closestDistance = sampleIndex * SampleDistance;
+	float closestDistanceSquared = sampleDistanceSquared;
+	for(int32 segmentStart = sampleIndex - 1; segmentStart <= sampleIndex; ++segmentStart)
+	{
+		if(segmentStart < 0 || segmentStart + 1 >= numSamples)
+		{
+			continue;
+		}
+
+		const FVector start(SampleX[segmentStart], SampleY[segmentStart], SampleZ[segmentStart]);
+		const FVector segment = FVector(SampleX[segmentStart + 1], SampleY[segmentStart + 1], SampleZ[segmentStart + 1]) - start;
+		const float segmentLengthSquared = segment.SizeSquared();
+		const float alpha = segmentLengthSquared > SMALL_NUMBER ? FMath::Clamp(((LocalLocation - start) | segment) / segmentLengthSquared, 0.f, 1.f) : 0.f;
+
+		const float distanceSquared = FVector::DistSquared(start + segment * alpha, LocalLocation);
+		if(distanceSquared < closestDistanceSquared)
+		{
+			closestDistanceSquared = distanceSquared;
+			closestDistance = (segmentStart + alpha) * SampleDistance;
+		}
+	}
+
+	return closestDistance;
+}
+
+FVector UCMCameraSubsystem_Rail::GetLocalLocationAtDistance(float Distance) const
+{
+	const int32 numSamples = SampleX.Num();
+	const float samplePosition = SampleDistance > 0.f ? FMath::Clamp(Distance / SampleDistance, 0.f, (float)(numSamples - 1)) : 0.f;
+	const int32 sampleIndex = FMath::Min(FMath::FloorToInt(samplePosition), numSamples - 2);
+	const float alpha = samplePosition - sampleIndex;
+
+	return FMath::Lerp(FVector(SampleX[sampleIndex], SampleY[sampleIndex], SampleZ[sampleIndex]),
+		FVector(SampleX[sampleIndex + 1], SampleY[sampleIndex + 1], SampleZ[sampleIndex + 1]), alpha);
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "CMCameraSubsystem.h"
+
+#include "CMCameraSubsystem_Rail.generated.h"
+
+class USplineComponent;
+
+UCLASS()
+class UCMCameraModeSubsystem_RailSettings : public UCMCameraModeSubsystem_BaseSettings
+{
+	GENERATED_BODY()
+public:
+	/** Tag of the actor whose spline component is the rail */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FName RailActorTag;
+
+	/** Distance between the samples of the lookup tables, in centimeters */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta=(ClampMin="1.0"))
+	float SampleSpacing = 50.f;
+
+	/** Samples the closest point may move per frame before the search falls back to a full scan, e.g. after a teleport */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta=(ClampMin="1"))
+	int32 MaxSearchSteps = 16;
+
+	/** How quickly the camera follows the closest point along the rail, zero follows instantly */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta=(ClampMin="0.0"))
+	float RailSpeed = 5.f;
+
+	/** World space offset from the rail */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FVector RailOffset = FVector::ZeroVector;
+};
+
+/**
+ * Keeps the camera on a spline at the point closest to the pawn, looking at the pawn.
+ * Uniform arc-length samples of the spline are built when the mode is entered, and every tick walks them from the previous closest sample,
+ * so the per frame cost does not depend on the length of the rail.
+ */
+UCLASS()
+class UCMCameraSubsystem_Rail : public UCMCameraSubsystem
+{
+	GENERATED_BODY()
+public:
+	UCMCameraSubsystem_Rail();
+
+	virtual void Tick(float DeltaTime) override;
+
+	virtual void OnEnterToCameraMode(const FCMCameraSubsystemContext& Context) override;
+
+	virtual void SetSubsystemSettings(UCMCameraModeSubsystem_BaseSettings* NewSettings) override;
+	virtual UCMCameraModeSubsystem_BaseSettings* GetSubsystemSettings() const override;
+
+	virtual FString GetDebugDescription() const override;
+
+	/** Logs the cost of the table lookup against USplineComponent::FindInputKeyClosestToWorldLocation along the rail */
+	void BenchmarkRailLookup(int32 Iterations);
+
+public:
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Instanced)
+	UCMCameraModeSubsystem_RailSettings* Settings;
+
+private:
+	void BuildRailTables();
+
+	/** Distance along the rail closest to LocalLocation, walks from ClosestSample and updates it */
+	float FindClosestDistance(const FVector& LocalLocation);
+
+	FVector GetLocalLocationAtDistance(float Distance) const;
+
+	FORCEINLINE float GetSampleDistanceSquared(int32 SampleIndex, const FVector& LocalLocation) const
+	{
+		return FMath::Square(SampleX[SampleIndex] - LocalLocation.X) + FMath::Square(SampleY[SampleIndex] - LocalLocation.Y) + FMath::Square(SampleZ[SampleIndex] - LocalLocation.Z);
+	}
+
+private:
+	TWeakObjectPtr<USplineComponent> RailSpline;
+
+	/** Spline local locations every SampleDistance along the rail */
+	TArray<float> SampleX;
+	TArray<float> SampleY;
+	TArray<float> SampleZ;
+	float SampleDistance = 0.f;
+	float RailLength = 0.f;
+
+	int32 ClosestSample = 0;
+	float CurrentRailDistance = 0.f;
+	bool bRailDistanceValid = false;
+};
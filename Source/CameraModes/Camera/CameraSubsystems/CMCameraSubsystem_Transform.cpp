@@ -1,11 +1,64 @@
 #include "CMCameraSubsystem_Transform.h"
 
+#include "CMCameraBenchmarkCommand.h"
 #include "GameFramework/Pawn.h"
 #include "CollisionQueryParams.h"
+#include "Components/MeshComponent.h"
 #include "WorldCollision.h"
 #include "Engine/World.h"
-#include "DrawDebugHelpers.h"
+#include "CameraModes/Camera/CMCameraFrameArena.h"
+#include "CameraModes/Camera/CMCameraStats.h"
 #include "CameraModes/Camera/CMSpringArmComponent.h"
+#include "HAL/PlatformTime.h"
+
+DECLARE_CYCLE_STAT(TEXT("Whisker probes"), STAT_CMWhiskerProbes, STATGROUP_CameraModes);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Whisker traces issued"), STAT_CMWhiskerTracesIssued, STATGROUP_CameraModes);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Self fade mesh writes"), STAT_CMSelfFadeMeshWrites, STATGROUP_CameraModes);
+
+namespace CMArmKernel
+{
+	/** Features the arm update is specialized on, one kernel is compiled per combination */
+	enum EFlags : uint32
+	{
+		Trace = 1 << 0,
+		LocationLag = 1 << 1,
+		RotationLag = 1 << 2,
+		LagSubstepping = 1 << 3,
+		PawnControlRotation = 1 << 4,
+		/** Rotation is relative and at least one axis is not inherited */
+		ConstrainRotation = 1 << 5,
+		/** Quality governor asks for probe reuse, read from Flags at runtime rather than specialized on */
+		CachedProbes = 1 << 6,
+	};
+
+	constexpr uint32 NumKernels = 1 << 6;
+	constexpr uint32 CallerFlags = Trace | LocationLag | RotationLag;
+
+	template<uint32 KernelFlags>
+	struct FStaticFlags
+	{
+		static constexpr bool Has(uint32 Flags, uint32 Flag)
+		{
+			return (KernelFlags & Flag) != 0;
+		}
+	};
+
+	/** Reads the features at runtime, used where no kernel is selected and as the benchmark baseline */
+	struct FDynamicFlags
+	{
+		static FORCEINLINE bool Has(uint32 Flags, uint32 Flag)
+		{
+			return (Flags & Flag) != 0;
+		}
+	};
+}
+
+#if !UE_BUILD_SHIPPING
+static TCMCameraBenchmarkCommand<UCMCameraSubsystem_Transform> CmdCameraBenchmarkArmKernels(
+	TEXT("CameraModes.Benchmark.ArmKernels"),
+	TEXT("Times the runtime-flag arm update against UpdateDesiredArmLocation with the specialized kernel selected on every spring arm in the world. Optional argument: iterations (default 10000)."),
+	&UCMCameraSubsystem_Transform::BenchmarkArmKernels, 10000);
+#endif
 
 UCMCameraSubsystem_Transform::UCMCameraSubsystem_Transform()
 {
@@ -20,25 +73,34 @@ void UCMCameraSubsystem_Transform::Tick(float DeltaTime)
 	CurrentTargetOffset = FMath::VInterpConstantTo(CurrentTargetOffset, Settings->TargetOffset, DeltaTime, Settings->TargetOffsetSpeed);
 	CurrentTargetArmLenght = FMath::FInterpConstantTo(CurrentTargetArmLenght, Settings->TargetArmLength, DeltaTime, Settings->TargetArmLengthSpeed);
 
+	auto& outputBuffer = GetOutputBuffer();
+	
 	if(const auto cameraManager = GetCameraManager())
 	{
-		cameraManager->ViewPitchMax = FMath::FInterpConstantTo(cameraManager->ViewPitchMax, Settings->ViewPitchMax, DeltaTime, Settings->ViewMinMaxSpeed);
-		cameraManager->ViewPitchMin = FMath::FInterpConstantTo(cameraManager->ViewPitchMin, Settings->ViewPitchMin, DeltaTime, Settings->ViewMinMaxSpeed);
+		float currentViewPitchMax = cameraManager->ViewPitchMax;
+		float currentViewPitchMin = cameraManager->ViewPitchMin;
+		outputBuffer.GetPendingViewPitchMax(currentViewPitchMax);
+		outputBuffer.GetPendingViewPitchMin(currentViewPitchMin);
+		
+		outputBuffer.SetViewPitchMax(FMath::FInterpConstantTo(currentViewPitchMax, Settings->ViewPitchMax, DeltaTime, Settings->ViewMinMaxSpeed));
+		outputBuffer.SetViewPitchMin(FMath::FInterpConstantTo(currentViewPitchMin, Settings->ViewPitchMin, DeltaTime, Settings->ViewMinMaxSpeed));
 	}
 	
-	if(FMath::Abs(GetOwningSpringArm()->GetPlayerRotationInput().Pitch) < Settings->MinPlayerInputToStopDesiredViewPitch
+	// A rotation target owns the pitch, the desired view pitch would fight it
+	if(!bHasRotationTarget && FMath::Abs(GetOwningSpringArm()->GetPlayerRotationInput().Pitch) < Settings->MinPlayerInputToStopDesiredViewPitch
 		&& GetOwningActor()->GetVelocity().SizeSquared() >= Settings->MinVelocityToActivateDesiredViewPitch * Settings->MinVelocityToActivateDesiredViewPitch)
 	{
 		const auto playerController = GetOwningController();
 		if(GetWorld()->GetTimeSeconds() > TimeBlockedDesiredView + Settings->MinTimeToActivateDesiredViewPitch)
 		{
-			const auto currentControlRotation = playerController->GetControlRotation();
+			auto currentControlRotation = playerController->GetControlRotation();
+			outputBuffer.GetPendingControlRotation(currentControlRotation);
 
 			auto resultControlRotation = currentControlRotation;
 			resultControlRotation.Pitch = Settings->DesiredViewPitch;
 			resultControlRotation = FMath::RInterpConstantTo(currentControlRotation, resultControlRotation, DeltaTime, Settings->ViewMinMaxSpeed);
 
-			playerController->SetControlRotation(resultControlRotation);
+			outputBuffer.SetControlRotation(resultControlRotation);
 		}
 	}
 	else
@@ -46,14 +108,40 @@ void UCMCameraSubsystem_Transform::Tick(float DeltaTime)
 		TimeBlockedDesiredView = GetWorld()->GetTimeSeconds();
 	}
 	
-	UpdateDesiredArmLocation(Settings->bDoCollisionTest, Settings->bEnableCameraLag, Settings->bEnableCameraRotationLag, DeltaTime);
-	
+	const bool bDoCollisionTest = ShouldDoCollisionTest();
+	if(bDoCollisionTest != bArmKernelCollisionTest)
+	{
+		UpdateProbeQuery(bDoCollisionTest);
+		RefreshArmKernel();
+	}
+	else if(GetOwningSpringArm()->IsUsingAbsoluteRotation() != bArmKernelAbsoluteRotation)
+	{
+		RefreshArmKernel();
+	}
+
+	UpdateDesiredArmLocation(bDoCollisionTest, Settings->bEnableCameraLag, Settings->bEnableCameraRotationLag, DeltaTime);
+
+	UpdateSelfFade();
 }
 
 void UCMCameraSubsystem_Transform::OnEnterToCameraMode(const FCMCameraSubsystemContext& Context)
 {
 	Super::OnEnterToCameraMode(Context);
 
+	UpdateProbeQuery(ShouldDoCollisionTest());
+
+	// Overriding subsystems set it again every tick while their mode is current
+	ClearCameraOverride();
+
+	const auto budgetGovernor = GetOwningSpringArm()->GetBudgetGovernor();
+	if(budgetGovernor != nullptr && !QualityLevelChangedHandle.IsValid())
+	{
+		QualityLevelGovernor = budgetGovernor;
+		QualityLevelChangedHandle = budgetGovernor->OnQualityLevelChanged.AddUObject(this, &UCMCameraSubsystem_Transform::OnQualityLevelChanged);
+	}
+
+	RefreshArmKernel();
+
 	if(!Context.bWithInterpolation)
 	{
 		CurrentSocketOffset = Settings->SocketOffset;
@@ -65,6 +153,22 @@ void UCMCameraSubsystem_Transform::OnEnterToCameraMode(const FCMCameraSubsystemC
 void UCMCameraSubsystem_Transform::SetSubsystemSettings(UCMCameraModeSubsystem_BaseSettings* NewSettings)
 {
 	Settings = Cast<UCMCameraModeSubsystem_TransformSettings>(NewSettings);
+
+	if(Settings != nullptr && GetOwningSpringArm() != nullptr)
+	{
+		RefreshArmKernel();
+	}
+}
+
+void UCMCameraSubsystem_Transform::BeginDestroy()
+{
+	if(QualityLevelGovernor.IsValid())
+	{
+		QualityLevelGovernor->OnQualityLevelChanged.Remove(QualityLevelChangedHandle);
+	}
+	QualityLevelChangedHandle.Reset();
+
+	Super::BeginDestroy();
 }
 
 UCMCameraModeSubsystem_BaseSettings* UCMCameraSubsystem_Transform::GetSubsystemSettings() const
@@ -72,20 +176,116 @@ UCMCameraModeSubsystem_BaseSettings* UCMCameraSubsystem_Transform::GetSubsystemS
 	return Settings;
 }
 
+void UCMCameraSubsystem_Transform::PredictPose(float LookAhead, FCMCameraPosePrediction& InOutPrediction) const
+{
+	// Offsets and arm length move at constant speeds, so their values after LookAhead are exact. Collision is not predicted.
+	const float armLength = FMath::FInterpConstantTo(CurrentTargetArmLenght, Settings->TargetArmLength, LookAhead, Settings->TargetArmLengthSpeed);
+	const FVector socketOffset = FMath::VInterpConstantTo(CurrentSocketOffset, Settings->SocketOffset, LookAhead, Settings->SocketOffsetSpeed);
+	const FVector targetOffset = FMath::VInterpConstantTo(CurrentTargetOffset, Settings->TargetOffset, LookAhead, Settings->TargetOffsetSpeed);
+
+	const FRotator rotation = InOutPrediction.Rotation;
+	const FVector armOrigin = GetOwningSpringArm()->GetComponentLocation() + GetOwningActor()->GetVelocity() * LookAhead + targetOffset;
+
+	InOutPrediction.Location = armOrigin - rotation.Vector() * armLength + FRotationMatrix(rotation).TransformVector(socketOffset);
+}
+
+void UCMCameraSubsystem_Transform::EstimateCost(const FCMCameraCostContext& Context, FCMCameraSubsystemCost& OutCost) const
+{
+	if(Settings->bDoCollisionTest && Settings->TargetArmLength != 0.f)
+	{
+		OutCost.NumSceneQueries += 1;
+		OutCost.SceneQueryShapes.Add(FString::Printf(TEXT("Sphere %.0f"), Settings->ProbeSize));
+
+		// Whiskers are async line traces, one per probe
+		OutCost.NumSceneQueries += Settings->WhiskerProbes.Num();
+		for(int32 index = 0; index < Settings->WhiskerProbes.Num(); ++index)
+		{
+			OutCost.SceneQueryShapes.Add(TEXT("Line"));
+		}
+	}
+
+	const int32 lagIterations = Settings->bUseCameraLagSubstepping ? FMath::CeilToInt(Context.WorstFrameTime / FMath::Max(Settings->CameraLagMaxTimeStep, 1.f / 200.f)) : 1;
+	OutCost.MaxLagIterations += (Settings->bEnableCameraLag ? lagIterations : 0) + (Settings->bEnableCameraRotationLag ? lagIterations : 0);
+
+	// View pitch limits and the desired view pitch
+	OutCost.NumOutputWrites += 3;
+}
+
+bool UCMCameraSubsystem_Transform::IsPoseSubsystem() const
+{
+	return true;
+}
+
+FString UCMCameraSubsystem_Transform::GetDebugDescription() const
+{
+	return FString::Printf(TEXT("Arm length %.0f -> %.0f, socket offset %s -> %s, target offset %s -> %s%s%s"),
+		CurrentTargetArmLenght, Settings->TargetArmLength,
+		*CurrentSocketOffset.ToCompactString(), *Settings->SocketOffset.ToCompactString(),
+		*CurrentTargetOffset.ToCompactString(), *Settings->TargetOffset.ToCompactString(),
+		bIsCameraFixed ? TEXT(", collision fix") : TEXT(""),
+		SelfFadeLevel > 0 ? *FString::Printf(TEXT(", self fade %d/%d"), SelfFadeLevel, FMath::Max(Settings->SelfFadeSteps, 1)) : TEXT(""));
+}
+
 FRotator UCMCameraSubsystem_Transform::GetDesiredRotation() const
 {
-	return GetCameraRotation();
+	// Without the additive offset, noise must not feed back into the arm
+	return (FTransform(RelativeSocketRotation, RelativeSocketLocation) * GetOwningSpringArm()->GetComponentTransform()).Rotator();
 }
 
 FRotator UCMCameraSubsystem_Transform::GetTargetRotation() const
+{
+	return EvaluateTargetRotation<CMArmKernel::FDynamicFlags>(MakeArmKernelFlags(ShouldDoCollisionTest(), Settings->bEnableCameraLag, Settings->bEnableCameraRotationLag));
+}
+
+FVector UCMCameraSubsystem_Transform::GetCameraLocation() const
+{
+	return GetCameraTransform().GetLocation();
+}
+
+FRotator UCMCameraSubsystem_Transform::GetCameraRotation() const
+{
+	return GetCameraTransform().Rotator();
+}
+
+FTransform UCMCameraSubsystem_Transform::GetCameraTransform() const
+{
+	return GetSocketTransform(NAME_None, ERelativeTransformSpace::RTS_World);
+}
+
+void UCMCameraSubsystem_Transform::UpdateDesiredArmLocation(bool bDoTrace, bool bDoLocationLag, bool bDoRotationLag, float DeltaTime)
+{
+	if(bHasCameraOverride)
+	{
+		ApplyCameraOverride();
+		return;
+	}
+
+	// Tick passes the settings the kernel was selected from, any other combination takes the unspecialized path
+	const uint32 requestedFlags = (ArmKernelFlags & ~CMArmKernel::CallerFlags)
+		| (bDoTrace ? CMArmKernel::Trace : 0)
+		| (bDoLocationLag ? CMArmKernel::LocationLag : 0)
+		| (bDoRotationLag ? CMArmKernel::RotationLag : 0);
+	if(requestedFlags != ArmKernelFlags)
+	{
+		EvaluateArm<CMArmKernel::FDynamicFlags>(DeltaTime, requestedFlags);
+		return;
+	}
+
+	(this->*ArmKernel)(DeltaTime, ArmKernelFlags);
+}
+
+template<typename TFlags>
+FRotator UCMCameraSubsystem_Transform::EvaluateTargetRotation(uint32 Flags) const
 {
 	FRotator DesiredRot = GetDesiredRotation();
 
-	if (Settings->bUsePawnControlRotation)
+	if (TFlags::Has(Flags, CMArmKernel::PawnControlRotation))
 	{
 		if (APawn* OwningPawn = GetOwningPawn())
 		{
-			const FRotator PawnViewRotation = OwningPawn->GetViewRotation();
+			// Control rotation written this frame is applied after the tick, the pawn does not see it yet
+			FRotator PawnViewRotation = OwningPawn->GetViewRotation();
+			GetOutputBuffer().GetPendingControlRotation(PawnViewRotation);
 			if (DesiredRot != PawnViewRotation)
 			{
 				DesiredRot = PawnViewRotation;
@@ -93,10 +293,15 @@ FRotator UCMCameraSubsystem_Transform::GetTargetRotation() const
 		}
 	}
 
-	// If inheriting rotation, check options for which components to inherit
-	if (!GetOwningSpringArm()->IsUsingAbsoluteRotation())
+	if (bHasRotationTarget)
 	{
-		const FRotator LocalRelativeRotation = GetSocketTransform(NAME_None, ERelativeTransformSpace::RTS_Component).Rotator();
+		DesiredRot = RotationTarget;
+	}
+
+	// If inheriting rotation and not every axis is inherited, take the rest from the socket
+	if (TFlags::Has(Flags, CMArmKernel::ConstrainRotation))
+	{
+		const FRotator LocalRelativeRotation = RelativeSocketRotation.Rotator();
 		if (!Settings->bInheritPitch)
 		{
 			DesiredRot.Pitch = LocalRelativeRotation.Pitch;
@@ -116,29 +321,15 @@ FRotator UCMCameraSubsystem_Transform::GetTargetRotation() const
 	return DesiredRot;
 }
 
-FVector UCMCameraSubsystem_Transform::GetCameraLocation() const
-{
-	return GetCameraTransform().GetLocation();
-}
-
-FRotator UCMCameraSubsystem_Transform::GetCameraRotation() const
-{
-	return GetCameraTransform().Rotator();
-}
-
-FTransform UCMCameraSubsystem_Transform::GetCameraTransform() const
-{
-	return GetSocketTransform(NAME_None, ERelativeTransformSpace::RTS_World);
-}
-
-void UCMCameraSubsystem_Transform::UpdateDesiredArmLocation(bool bDoTrace, bool bDoLocationLag, bool bDoRotationLag, float DeltaTime)
+template<typename TFlags>
+void UCMCameraSubsystem_Transform::EvaluateArm(float DeltaTime, uint32 Flags)
 {
-	FRotator DesiredRot = GetTargetRotation();
+	FRotator DesiredRot = EvaluateTargetRotation<TFlags>(Flags);
 
 	// Apply 'lag' to rotation if desired
-	if(bDoRotationLag)
+	if (TFlags::Has(Flags, CMArmKernel::RotationLag))
 	{
-		if (Settings->bUseCameraLagSubstepping && DeltaTime > Settings->CameraLagMaxTimeStep && Settings->CameraRotationLagSpeed > 0.f)
+		if (TFlags::Has(Flags, CMArmKernel::LagSubstepping) && DeltaTime > Settings->CameraLagMaxTimeStep && Settings->CameraRotationLagSpeed > 0.f)
 		{
 			const FRotator ArmRotStep = (DesiredRot - PreviousDesiredRot).GetNormalized() * (1.f / DeltaTime);
 			FRotator LerpTarget = PreviousDesiredRot;
@@ -164,9 +355,9 @@ void UCMCameraSubsystem_Transform::UpdateDesiredArmLocation(bool bDoTrace, bool
 	FVector ArmOrigin = GetOwningSpringArm()->GetComponentLocation() + CurrentTargetOffset;
 	// We lag the target, not the actual camera position, so rotating the camera around does not have lag
 	FVector DesiredLoc = ArmOrigin;
-	if (bDoLocationLag)
+	if (TFlags::Has(Flags, CMArmKernel::LocationLag))
 	{
-		if (Settings->bUseCameraLagSubstepping && DeltaTime > Settings->CameraLagMaxTimeStep && Settings->CameraLagSpeed > 0.f)
+		if (TFlags::Has(Flags, CMArmKernel::LagSubstepping) && DeltaTime > Settings->CameraLagMaxTimeStep && Settings->CameraLagSpeed > 0.f)
 		{
 			const FVector ArmMovementStep = (DesiredLoc - PreviousDesiredLoc) * (1.f / DeltaTime);
 			FVector LerpTarget = PreviousDesiredLoc;
@@ -199,15 +390,16 @@ void UCMCameraSubsystem_Transform::UpdateDesiredArmLocation(bool bDoTrace, bool
 			}
 		}		
 
-#if !(UE_BUILD_SHIPPING || UE_BUILD_TEST)
-		if (Settings->bDrawDebugLagMarkers)
+#if CM_CAMERA_DEBUG
+		if (Settings->bDrawDebugLagMarkers || FCMCameraDebugDrawer::IsEnabled(ECMCameraDebugFlags::Lag))
 		{
-			DrawDebugSphere(GetWorld(), ArmOrigin, 5.f, 8, FColor::Green);
-			DrawDebugSphere(GetWorld(), DesiredLoc, 5.f, 8, FColor::Yellow);
+			auto& DebugDrawer = GetOwningSpringArm()->GetDebugDrawer();
+			DebugDrawer.DrawSphere(ArmOrigin, 5.f, FColor::Green);
+			DebugDrawer.DrawSphere(DesiredLoc, 5.f, FColor::Yellow);
 
 			const FVector ToOrigin = ArmOrigin - DesiredLoc;
-			DrawDebugDirectionalArrow(GetWorld(), DesiredLoc, DesiredLoc + ToOrigin * 0.5f, 7.5f, bClampedDist ? FColor::Red : FColor::Green);
-			DrawDebugDirectionalArrow(GetWorld(), DesiredLoc + ToOrigin * 0.5f, ArmOrigin,  7.5f, bClampedDist ? FColor::Red : FColor::Green);
+			DebugDrawer.DrawArrow(DesiredLoc, DesiredLoc + ToOrigin * 0.5f, 7.5f, bClampedDist ? FColor::Red : FColor::Green);
+			DebugDrawer.DrawArrow(DesiredLoc + ToOrigin * 0.5f, ArmOrigin,  7.5f, bClampedDist ? FColor::Red : FColor::Green);
 		}
 #endif
 	}
@@ -222,18 +414,50 @@ void UCMCameraSubsystem_Transform::UpdateDesiredArmLocation(bool bDoTrace, bool
 
 	// Do a sweep to ensure we are not penetrating the world
 	FVector ResultLoc;
-	if (bDoTrace && (Settings->TargetArmLength != 0.0f))
+	if (TFlags::Has(Flags, CMArmKernel::Trace) && (Settings->TargetArmLength != 0.0f))
 	{
 		bIsCameraFixed = true;
-		FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(SpringArm), false, GetOwningActor());
+		if(ProbeQueryHandle == INDEX_NONE)
+		{
+			UpdateProbeQuery(true);
+		}
 
+		// Under budget pressure every other frame reuses the last probe fraction along the arm
 		FHitResult Result;
-		GetWorld()->SweepSingleByChannel(Result, ArmOrigin, DesiredLoc, FQuat::Identity, Settings->ProbeChannel, FCollisionShape::MakeSphere(Settings->ProbeSize), QueryParams);
+		if(CMArmKernel::FDynamicFlags::Has(Flags, CMArmKernel::CachedProbes) && !bProbeReusedLastFrame)
+		{
+			bProbeReusedLastFrame = true;
+			Result.bBlockingHit = bCachedProbeHit;
+			Result.Time = CachedProbeHitTime;
+			Result.Location = FMath::Lerp(ArmOrigin, DesiredLoc, CachedProbeHitTime);
+		}
+		else
+		{
+			bProbeReusedLastFrame = false;
+			GetOwningSpringArm()->GetQueryBroker().ResolveSingle(ProbeQueryHandle, ArmOrigin, DesiredLoc, FQuat::Identity, Result);
+			bCachedProbeHit = Result.bBlockingHit;
+			CachedProbeHitTime = Result.bBlockingHit ? Result.Time : 1.f;
+		}
 		
 		UnfixedCameraPosition = DesiredLoc;
 
+		UpdateWhiskerProbes(ArmOrigin, DesiredLoc, DesiredRot);
+
 		ResultLoc = BlendLocations(DesiredLoc, Result.Location, Result.bBlockingHit, DeltaTime);
 
+#if CM_CAMERA_DEBUG
+		if (FCMCameraDebugDrawer::IsEnabled(ECMCameraDebugFlags::Probes))
+		{
+			auto& DebugDrawer = GetOwningSpringArm()->GetDebugDrawer();
+			DebugDrawer.DrawLine(ArmOrigin, DesiredLoc, Result.bBlockingHit ? FColor::Red : FColor::Green);
+			DebugDrawer.DrawSphere(DesiredLoc, Settings->ProbeSize, FColor::Green);
+			if (Result.bBlockingHit)
+			{
+				DebugDrawer.DrawSphere(Result.Location, Settings->ProbeSize, FColor::Red);
+			}
+		}
+#endif
+
 		if (ResultLoc == DesiredLoc) 
 		{	
 			bIsCameraFixed = false;
@@ -246,6 +470,8 @@ void UCMCameraSubsystem_Transform::UpdateDesiredArmLocation(bool bDoTrace, bool
 		UnfixedCameraPosition = ResultLoc;
 	}
 
+	ResolvedArmLength = FVector::Dist(ArmOrigin, ResultLoc);
+
 	// Form a transform for new world transform for camera
 	FTransform WorldCamTM(DesiredRot, ResultLoc);
 	// Convert to relative to component
@@ -257,9 +483,224 @@ void UCMCameraSubsystem_Transform::UpdateDesiredArmLocation(bool bDoTrace, bool
 	RelativeSocketRotation = RelCamTM.GetRotation();
 }
 
+uint32 UCMCameraSubsystem_Transform::MakeArmKernelFlags(bool bDoTrace, bool bDoLocationLag, bool bDoRotationLag) const
+{
+	const auto springArm = GetOwningSpringArm();
+	const bool bConstrainRotation = !springArm->IsUsingAbsoluteRotation() && !(Settings->bInheritPitch && Settings->bInheritYaw && Settings->bInheritRoll);
+	const bool bUseCameraLagSubstepping = Settings->bUseCameraLagSubstepping && !IsQualityReduced(ECMCameraQualityLevel::NoLagSubstepping);
+
+	return (bDoTrace ? CMArmKernel::Trace : 0)
+		| (bDoLocationLag ? CMArmKernel::LocationLag : 0)
+		| (bDoRotationLag ? CMArmKernel::RotationLag : 0)
+		| (bUseCameraLagSubstepping ? CMArmKernel::LagSubstepping : 0)
+		| (Settings->bUsePawnControlRotation ? CMArmKernel::PawnControlRotation : 0)
+		| (bConstrainRotation ? CMArmKernel::ConstrainRotation : 0)
+		| (IsQualityReduced(ECMCameraQualityLevel::CachedProbes) ? CMArmKernel::CachedProbes : 0);
+}
+
+void UCMCameraSubsystem_Transform::SelectArmKernel(uint32 Flags)
+{
+	ArmKernelFlags = Flags;
+	ArmKernel = GetArmKernel(Flags & (CMArmKernel::NumKernels - 1), TMakeIntegerSequence<uint32, CMArmKernel::NumKernels>());
+	bArmKernelAbsoluteRotation = GetOwningSpringArm()->IsUsingAbsoluteRotation();
+	bArmKernelCollisionTest = (Flags & CMArmKernel::Trace) != 0;
+}
+
+void UCMCameraSubsystem_Transform::RefreshArmKernel()
+{
+	SelectArmKernel(MakeArmKernelFlags(ShouldDoCollisionTest(), Settings->bEnableCameraLag, Settings->bEnableCameraRotationLag));
+}
+
+void UCMCameraSubsystem_Transform::OnQualityLevelChanged(ECMCameraQualityLevel QualityLevel)
+{
+	if(Settings != nullptr)
+	{
+		RefreshArmKernel();
+	}
+}
+
+template<uint32... KernelFlags>
+UCMCameraSubsystem_Transform::FArmKernel UCMCameraSubsystem_Transform::GetArmKernel(uint32 Flags, TIntegerSequence<uint32, KernelFlags...>)
+{
+	static const FArmKernel armKernels[] = { &UCMCameraSubsystem_Transform::EvaluateArm<CMArmKernel::FStaticFlags<KernelFlags>>... };
+	return armKernels[Flags];
+}
+
+void UCMCameraSubsystem_Transform::BenchmarkArmKernels(int32 Iterations)
+{
+	if(Settings == nullptr || GetOwningSpringArm() == nullptr)
+	{
+		return;
+	}
+
+	// Kernels advance lag and probe state, put it back afterwards so the benchmark does not pop the camera
+	const auto savedPreviousDesiredLoc = PreviousDesiredLoc;
+	const auto savedPreviousArmOrigin = PreviousArmOrigin;
+	const auto savedPreviousDesiredRot = PreviousDesiredRot;
+	const auto savedRelativeSocketLocation = RelativeSocketLocation;
+	const auto savedRelativeSocketRotation = RelativeSocketRotation;
+	const auto savedUnfixedCameraPosition = UnfixedCameraPosition;
+	const auto bSavedIsCameraFixed = bIsCameraFixed;
+	const auto bSavedCachedProbeHit = bCachedProbeHit;
+	const auto savedCachedProbeHitTime = CachedProbeHitTime;
+	const auto bSavedProbeReusedLastFrame = bProbeReusedLastFrame;
+	const auto savedWhiskerArmFraction = WhiskerArmFraction;
+	const auto bSavedHasCameraOverride = bHasCameraOverride;
+	bHasCameraOverride = false;
+
+	const uint32 rotationFlags = MakeArmKernelFlags(false, false, false);
+	const uint32 variants[] = {
+		rotationFlags,
+		rotationFlags | CMArmKernel::LocationLag,
+		rotationFlags | CMArmKernel::LocationLag | CMArmKernel::RotationLag,
+		rotationFlags | CMArmKernel::Trace,
+		rotationFlags | CMArmKernel::Trace | CMArmKernel::LocationLag,
+	};
+
+	constexpr float deltaTime = 1.f / 60.f;
+	
+	for(const auto variantFlags : variants)
+	{
+		const auto dynamicStartTime = FPlatformTime::Seconds();
+		for(int32 iteration = 0; iteration < Iterations; ++iteration)
+		{
+			EvaluateArm<CMArmKernel::FDynamicFlags>(deltaTime, variantFlags);
+		}
+		const auto dynamicTime = FPlatformTime::Seconds() - dynamicStartTime;
+
+		// The path the tick takes, kernel call through UpdateDesiredArmLocation included
+		SelectArmKernel(variantFlags);
+		const bool bDoTrace = (variantFlags & CMArmKernel::Trace) != 0;
+		const bool bDoLocationLag = (variantFlags & CMArmKernel::LocationLag) != 0;
+		const bool bDoRotationLag = (variantFlags & CMArmKernel::RotationLag) != 0;
+		const auto staticStartTime = FPlatformTime::Seconds();
+		for(int32 iteration = 0; iteration < Iterations; ++iteration)
+		{
+			UpdateDesiredArmLocation(bDoTrace, bDoLocationLag, bDoRotationLag, deltaTime);
+		}
+		const auto staticTime = FPlatformTime::Seconds() - staticStartTime;
+
+		UE_LOG(LogTemp, Display, TEXT("Arm kernel 0x%02x: dynamic %.3f us, UpdateDesiredArmLocation %.3f us per update"),
+			variantFlags, dynamicTime * 1000000.0 / Iterations, staticTime * 1000000.0 / Iterations);
+	}
+
+	PreviousDesiredLoc = savedPreviousDesiredLoc;
+	PreviousArmOrigin = savedPreviousArmOrigin;
+	PreviousDesiredRot = savedPreviousDesiredRot;
+	RelativeSocketLocation = savedRelativeSocketLocation;
+	RelativeSocketRotation = savedRelativeSocketRotation;
+	UnfixedCameraPosition = savedUnfixedCameraPosition;
+	bIsCameraFixed = bSavedIsCameraFixed;
+	bCachedProbeHit = bSavedCachedProbeHit;
+	CachedProbeHitTime = savedCachedProbeHitTime;
+	bProbeReusedLastFrame = bSavedProbeReusedLastFrame;
+	WhiskerArmFraction = savedWhiskerArmFraction;
+	bHasCameraOverride = bSavedHasCameraOverride;
+	RefreshArmKernel();
+}
+
 FVector UCMCameraSubsystem_Transform::BlendLocations(const FVector& DesiredArmLocation, const FVector& TraceHitLocation, bool bHitSomething, float DeltaTime)
 {
-	return bHitSomething ? TraceHitLocation : DesiredArmLocation;
+	if(Settings->WhiskerProbes.Num() == 0)
+	{
+		return bHitSomething ? TraceHitLocation : DesiredArmLocation;
+	}
+
+	// The probe sphere hit is also a target of the smoothed length, so the arm extends smoothly once it clears
+	const float armLength = FVector::Dist(PreviousArmOrigin, DesiredArmLocation);
+	const float hitFraction = bHitSomething && armLength > KINDA_SMALL_NUMBER ? FVector::Dist(PreviousArmOrigin, TraceHitLocation) / armLength : 1.f;
+	WhiskerArmFraction = FMath::FInterpTo(WhiskerArmFraction, FMath::Min(WhiskerTargetFraction, hitFraction), DeltaTime, Settings->WhiskerArmLengthSpeed);
+
+	// Never further out than the probe sphere allows
+	return FMath::Lerp(PreviousArmOrigin, DesiredArmLocation, FMath::Min(WhiskerArmFraction, hitFraction));
+}
+
+void UCMCameraSubsystem_Transform::UpdateWhiskerProbes(const FVector& ArmOrigin, const FVector& DesiredLoc, const FRotator& DesiredRot)
+{
+	SCOPE_CYCLE_COUNTER(STAT_CMWhiskerProbes);
+
+	// Traces issued now would never complete while async probes are suspended, the arm relies on the probe sphere alone
+	const auto& whiskerProbes = Settings->WhiskerProbes;
+	if(whiskerProbes.Num() == 0 || GetOwningSpringArm()->AreAsyncProbesSuspended())
+	{
+		WhiskerTraces.Reset();
+		WhiskerTargetFraction = 1.f;
+		WhiskerArmFraction = 1.f;
+		return;
+	}
+
+	const auto world = GetWorld();
+
+	// Results arrive together, a batch still in flight keeps the last target
+	if(WhiskerTraces.Num() > 0)
+	{
+		// Whiskers point away from the arm, hit.Time is a fraction of the whisker, the hit projected on the arm is the one the arm needs
+		const FVector arm = DesiredLoc - ArmOrigin;
+		const float armLengthSquared = arm.SizeSquared();
+
+		float nearestFraction = 1.f;
+		for(const auto& whiskerTrace : WhiskerTraces)
+		{
+			FTraceDatum traceDatum;
+			if(world->QueryTraceData(whiskerTrace, traceDatum))
+			{
+				for(const auto& hit : traceDatum.OutHits)
+				{
+					if(hit.bBlockingHit && armLengthSquared > KINDA_SMALL_NUMBER)
+					{
+						const float armFraction = ((hit.ImpactPoint - ArmOrigin) | arm) / armLengthSquared;
+						nearestFraction = FMath::Min(nearestFraction, FMath::Clamp(armFraction, 0.f, 1.f));
+					}
+				}
+			}
+			else if(world->IsTraceHandleValid(whiskerTrace, false))
+			{
+				return;
+			}
+		}
+
+		WhiskerTargetFraction = nearestFraction;
+		WhiskerTraces.Reset();
+	}
+
+	const FVector localArm = DesiredRot.UnrotateVector(DesiredLoc - ArmOrigin);
+	const FVector velocity = GetOwningActor()->GetVelocity();
+	const FCollisionQueryParams queryParams(SCENE_QUERY_STAT(CMCameraWhiskerProbe), false, GetOwningActor());
+
+	for(const auto& whiskerProbe : whiskerProbes)
+	{
+		const FVector probeArm = DesiredRot.RotateVector(FRotator(whiskerProbe.PitchOffset, whiskerProbe.YawOffset, 0.f).RotateVector(localArm));
+		const FVector probeEnd = ArmOrigin + probeArm + velocity * whiskerProbe.VelocityLookAhead;
+
+		WhiskerTraces.Add(world->AsyncLineTraceByChannel(EAsyncTraceType::Single, ArmOrigin, probeEnd, Settings->ProbeChannel, queryParams));
+	}
+
+	INC_DWORD_STAT_BY(STAT_CMWhiskerTracesIssued, whiskerProbes.Num());
+}
+
+void UCMCameraSubsystem_Transform::UpdateProbeQuery(bool bDoTrace)
+{
+	auto& queryBroker = GetOwningSpringArm()->GetQueryBroker();
+	if(bDoTrace)
+	{
+		FCMCameraSceneQuery probeQuery;
+		probeQuery.Channel = Settings->ProbeChannel;
+		probeQuery.Shape = FCollisionShape::MakeSphere(Settings->ProbeSize);
+		probeQuery.bMultiHit = false;
+		probeQuery.bIgnoreOwner = true;
+		
+		ProbeQueryHandle = queryBroker.SetQuery(ProbeQueryHandle, probeQuery);
+	}
+	else
+	{
+		queryBroker.RemoveQuery(ProbeQueryHandle);
+		ProbeQueryHandle = INDEX_NONE;
+	}
+}
+
+bool UCMCameraSubsystem_Transform::ShouldDoCollisionTest() const
+{
+	return Settings->bDoCollisionTest && GetOwningSpringArm()->GetCameraEvaluation() == ECMCameraEvaluation::Full;
 }
 
 // void UCMCameraSubsystem_Transform::OnRegister()
@@ -274,6 +715,7 @@ FVector UCMCameraSubsystem_Transform::BlendLocations(const FVector& DesiredArmLo
 FTransform UCMCameraSubsystem_Transform::GetSocketTransform(FName InSocketName, ERelativeTransformSpace TransformSpace) const
 {
 	FTransform RelativeTransform(RelativeSocketRotation, RelativeSocketLocation);
+	RelativeTransform = FTransform(AdditiveRotationOffset, AdditiveLocationOffset) * RelativeTransform;
 
 	switch(TransformSpace)
 	{
@@ -301,6 +743,105 @@ FTransform UCMCameraSubsystem_Transform::GetSocketTransform(FName InSocketName,
 	return RelativeTransform;
 }
 
+void UCMCameraSubsystem_Transform::SetAdditiveCameraOffset(const FVector& LocationOffset, const FRotator& RotationOffset)
+{
+	AdditiveLocationOffset = LocationOffset;
+	AdditiveRotationOffset = RotationOffset.Quaternion();
+}
+
+void UCMCameraSubsystem_Transform::SetRotationTarget(const FRotator& NewRotationTarget)
+{
+	bHasRotationTarget = true;
+	RotationTarget = NewRotationTarget;
+}
+
+void UCMCameraSubsystem_Transform::ClearRotationTarget()
+{
+	bHasRotationTarget = false;
+}
+
+void UCMCameraSubsystem_Transform::SetCameraOverride(const FVector& WorldLocation, const FRotator& WorldRotation)
+{
+	bHasCameraOverride = true;
+	CameraOverride = FTransform(WorldRotation, WorldLocation);
+
+	// Applied right away as well, the overriding subsystem may tick after this one
+	ApplyCameraOverride();
+}
+
+void UCMCameraSubsystem_Transform::ClearCameraOverride()
+{
+	bHasCameraOverride = false;
+}
+
+void UCMCameraSubsystem_Transform::ApplyCameraOverride()
+{
+	const FTransform RelCamTM = CameraOverride.GetRelativeTransform(GetOwningSpringArm()->GetComponentTransform());
+	RelativeSocketLocation = RelCamTM.GetLocation();
+	RelativeSocketRotation = RelCamTM.GetRotation();
+	UnfixedCameraPosition = CameraOverride.GetLocation();
+	bIsCameraFixed = false;
+	ResolvedArmLength = FVector::Dist(GetOwningSpringArm()->GetComponentLocation(), CameraOverride.GetLocation());
+}
+
+void UCMCameraSubsystem_Transform::UpdateSelfFade()
+{
+	const int32 numSteps = FMath::Max(Settings->SelfFadeSteps, 1);
+
+	// Rounding towards the current level gives every boundary a step of hysteresis, an arm resting on one does not rewrite the meshes
+	// Full evaluation is the local view, a server approximating a remote pawn would fade it on the host's screen.
+	// Leaving the local view falls back to level 0, which restores the meshes.
+	int32 fadeLevel = 0;
+	if(Settings->bEnableSelfFade && GetOwningSpringArm()->GetCameraEvaluation() == ECMCameraEvaluation::Full)
+	{
+		const float scaledFade = FMath::Clamp(FMath::GetRangePct(Settings->SelfFadeStartArmLength, Settings->SelfFadeEndArmLength, ResolvedArmLength), 0.f, 1.f) * numSteps;
+		fadeLevel = SelfFadeLevel;
+		if(FMath::FloorToInt(scaledFade) > SelfFadeLevel)
+		{
+			fadeLevel = FMath::FloorToInt(scaledFade);
+		}
+		else if(FMath::CeilToInt(scaledFade) < SelfFadeLevel)
+		{
+			fadeLevel = FMath::CeilToInt(scaledFade);
+		}
+	}
+
+	if(fadeLevel == SelfFadeLevel)
+	{
+		return;
+	}
+
+	const bool bWasHidden = SelfFadeLevel >= numSteps;
+	const bool bHidden = fadeLevel >= numSteps;
+	SelfFadeLevel = fadeLevel;
+
+	TCMFrameArray<UMeshComponent*> meshComponents;
+	GetOwningActor()->GetComponents(meshComponents);
+	for(const auto meshComponent : meshComponents)
+	{
+		meshComponent->SetCustomPrimitiveDataFloat(Settings->SelfFadeCustomDataIndex, (float)fadeLevel / numSteps);
+
+		if(bHidden && !bWasHidden && !meshComponent->bOwnerNoSee)
+		{
+			meshComponent->SetOwnerNoSee(true);
+			SelfFadeHiddenMeshes.Add(meshComponent);
+		}
+	}
+	INC_DWORD_STAT_BY(STAT_CMSelfFadeMeshWrites, meshComponents.Num());
+
+	if(bWasHidden && !bHidden)
+	{
+		for(const auto& hiddenMesh : SelfFadeHiddenMeshes)
+		{
+			if(hiddenMesh.IsValid())
+			{
+				hiddenMesh->SetOwnerNoSee(false);
+			}
+		}
+		SelfFadeHiddenMeshes.Reset();
+	}
+}
+
 FVector UCMCameraSubsystem_Transform::GetUnfixedCameraPosition() const
 {
 	return UnfixedCameraPosition;
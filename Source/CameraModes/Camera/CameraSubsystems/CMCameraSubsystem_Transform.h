@@ -1,9 +1,29 @@
 #pragma once
 
 #include "CMCameraSubsystem.h"
+#include "Templates/IntegerSequence.h"
+#include "WorldCollision.h"
 
 #include "CMCameraSubsystem_Transform.generated.h"
 
+/** Ray around the spring arm that sees obstacles before the probe sphere hits them */
+USTRUCT(BlueprintType)
+struct FCMCameraWhiskerProbe
+{
+	GENERATED_BODY()
+public:
+	/** Rotation of the ray away from the arm, in the arm's frame. Side whiskers use yaw. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float YawOffset = 0.f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float PitchOffset = 0.f;
+
+	/** Seconds of pawn velocity added to the end of the ray, looks where the camera is heading */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta=(ClampMin="0.0"))
+	float VelocityLookAhead = 0.f;
+};
+
 UCLASS()
 class UCMCameraModeSubsystem_TransformSettings : public UCMCameraModeSubsystem_BaseSettings
 {
@@ -62,6 +82,37 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=CameraCollision)
 	bool bDoCollisionTest = true;
 
+	/**
+	 * Rays traced asynchronously around the arm. The nearest hit of the previous frame pulls the arm in smoothly,
+	 * so the probe sphere rarely has to snap.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=CameraCollision, meta=(editcondition="bDoCollisionTest"))
+	TArray<FCMCameraWhiskerProbe> WhiskerProbes;
+
+	/** How quickly the arm follows the whisker length, in and out */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=CameraCollision, meta=(editcondition="bDoCollisionTest", ClampMin="0.0"))
+	float WhiskerArmLengthSpeed = 5.f;
+
+	/** Fade the owner's meshes out as the arm gets short, e.g. when collision pulls the camera into the pawn */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=SelfFade)
+	bool bEnableSelfFade = false;
+
+	/** Arm length the fade starts at */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=SelfFade, meta=(editcondition="bEnableSelfFade", ClampMin="0.0"))
+	float SelfFadeStartArmLength = 100.f;
+
+	/** Arm length the owner is fully faded at, its meshes switch to owner no see from there */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=SelfFade, meta=(editcondition="bEnableSelfFade", ClampMin="0.0"))
+	float SelfFadeEndArmLength = 40.f;
+
+	/** Fade levels between visible and hidden, meshes are only written when the level changes */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=SelfFade, meta=(editcondition="bEnableSelfFade", ClampMin="1"))
+	int32 SelfFadeSteps = 4;
+
+	/** Custom primitive data the fade in [0, 1] is written to, read by the owner's materials */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=SelfFade, meta=(editcondition="bEnableSelfFade", ClampMin="0"))
+	int32 SelfFadeCustomDataIndex = 0;
+
 	/**
 	 * If this component is placed on a pawn, should it use the view/control rotation of the pawn where possible?
 	 * When disabled, the component will revert to using the stored RelativeRotation of the component.
@@ -143,8 +194,18 @@ public:
 
 	virtual void OnEnterToCameraMode(const FCMCameraSubsystemContext& Context) override;
 
+	virtual void BeginDestroy() override;
+
 	virtual void SetSubsystemSettings(UCMCameraModeSubsystem_BaseSettings* Settings) override;
 	virtual UCMCameraModeSubsystem_BaseSettings* GetSubsystemSettings() const override;
+
+	virtual void PredictPose(float LookAhead, FCMCameraPosePrediction& InOutPrediction) const override;
+
+	virtual void EstimateCost(const FCMCameraCostContext& Context, FCMCameraSubsystemCost& OutCost) const override;
+
+	virtual bool IsPoseSubsystem() const override;
+
+	virtual FString GetDebugDescription() const override;
 	
 	/**
 	* Get the target rotation we inherit, used as the base target for the boom rotation.
@@ -163,6 +224,27 @@ public:
 	
 	FTransform GetSocketTransform(FName InSocketName, ERelativeTransformSpace TransformSpace = RTS_World) const;
 
+	/** Camera space offset added on top of the socket, e.g. by UCMCameraSubsystem_Noise. The arm itself never sees it. */
+	void SetAdditiveCameraOffset(const FVector& LocationOffset, const FRotator& RotationOffset);
+
+	/** Replaces the pawn and component rotation as the arm target, e.g. by UCMCameraSubsystem_LockOn. Lag and inherit constraints still apply. */
+	void SetRotationTarget(const FRotator& NewRotationTarget);
+	void ClearRotationTarget();
+
+	/** Places the camera at a world transform instead of on the arm, e.g. by UCMCameraSubsystem_Rail. The arm is not evaluated meanwhile. */
+	void SetCameraOverride(const FVector& WorldLocation, const FRotator& WorldRotation);
+	void ClearCameraOverride();
+
+	/**
+	 * Selects the arm update specialized on the current settings. Done on mode changes, quality steps, absolute rotation and evaluation changes,
+	 * call it after changing collision, lag or rotation settings at runtime.
+	 */
+	UFUNCTION(BlueprintCallable, Category=SpringArm)
+	void RefreshArmKernel();
+
+	/** Logs the cost of the runtime-flag arm update against the specialized kernels for the common feature combinations */
+	void BenchmarkArmKernels(int32 Iterations);
+
 public:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Instanced)
 	UCMCameraModeSubsystem_TransformSettings* Settings;
@@ -187,12 +269,43 @@ protected:
 	/** Updates the desired arm location, calling BlendLocations to do the actual blending if a trace is done */
 	virtual void UpdateDesiredArmLocation(bool bDoTrace, bool bDoLocationLag, bool bDoRotationLag, float DeltaTime);
 
+	/**
+	 * Arm update written once and compiled per feature combination.
+	 * TFlags either bakes the features in, so the kernel carries no feature branches, or reads them from Flags.
+	 */
+	template<typename TFlags>
+	void EvaluateArm(float DeltaTime, uint32 Flags);
+	
+	template<typename TFlags>
+	FRotator EvaluateTargetRotation(uint32 Flags) const;
+
+	uint32 MakeArmKernelFlags(bool bDoTrace, bool bDoLocationLag, bool bDoRotationLag) const;
+	
+	/** Picks the kernel specialized on Flags, done when settings or quality level change instead of every frame */
+	void SelectArmKernel(uint32 Flags);
+
+	void OnQualityLevelChanged(ECMCameraQualityLevel QualityLevel);
+
 	/**
 	 * This function allows subclasses to blend the trace hit location with the desired arm location;
 	 * by default it returns bHitSomething ? TraceHitLocation : DesiredArmLocation
 	 */
 	virtual FVector BlendLocations(const FVector& DesiredArmLocation, const FVector& TraceHitLocation, bool bHitSomething, float DeltaTime);
 
+	/** Registers the collision probe in the spring arm query broker, or removes it when collision test is disabled */
+	void UpdateProbeQuery(bool bDoTrace);
+
+	/** Collision test is only done for fully evaluated arms, pose-only approximations (e.g. remote players on a server) skip the sweeps */
+	bool ShouldDoCollisionTest() const;
+
+	void ApplyCameraOverride();
+
+	/** Reads the whisker results of the previous frame and queues this frame's rays as one batch of async traces */
+	void UpdateWhiskerProbes(const FVector& ArmOrigin, const FVector& DesiredLoc, const FRotator& DesiredRot);
+
+	/** Quantizes ResolvedArmLength into a fade level and writes the owner's meshes when the level changes */
+	void UpdateSelfFade();
+
 protected:
 	float TimeBlockedDesiredView = 0.f; 
 	
@@ -200,15 +313,61 @@ protected:
 	bool bIsCameraFixed = false;
 	FVector UnfixedCameraPosition = FVector::ZeroVector;
 
+	/** Handle of the collision probe in the spring arm query broker */
+	int32 ProbeQueryHandle = INDEX_NONE;
+
+	/** Last collision probe result, reused on alternate frames at CachedProbes quality level */
+	bool bCachedProbeHit = false;
+	float CachedProbeHitTime = 1.f;
+	bool bProbeReusedLastFrame = false;
+
+	/** Whisker traces in flight, all issued in the same frame */
+	TArray<FTraceHandle, TInlineAllocator<8>> WhiskerTraces;
+	/** Nearest whisker hit along its ray, 1 when nothing was hit */
+	float WhiskerTargetFraction = 1.f;
+	/** Smoothed fraction of the arm length the camera is allowed to use */
+	float WhiskerArmFraction = 1.f;
+
+	/** Distance from the arm origin to the camera after collision, drives the self fade */
+	float ResolvedArmLength = 0.f;
+	/** Fade level last written to the owner's meshes, 0 is fully visible */
+	int32 SelfFadeLevel = 0;
+	/** Meshes switched to owner no see by the self fade, meshes hidden from the owner by design are left alone */
+	TArray<TWeakObjectPtr<UMeshComponent>, TInlineAllocator<4>> SelfFadeHiddenMeshes;
+
 	/** Temporary variables when using camera lag, to record previous camera position */
 	FVector PreviousDesiredLoc= FVector::ZeroVector;
 	FVector PreviousArmOrigin= FVector::ZeroVector;
 	/** Temporary variable for lagging camera rotation, for previous rotation */
 	FRotator PreviousDesiredRot = FRotator::ZeroRotator;
 
+	using FArmKernel = void (UCMCameraSubsystem_Transform::*)(float DeltaTime, uint32 Flags);
+
+	template<uint32... KernelFlags>
+	static FArmKernel GetArmKernel(uint32 Flags, TIntegerSequence<uint32, KernelFlags...>);
+
+	FArmKernel ArmKernel = nullptr;
+	uint32 ArmKernelFlags = MAX_uint32;
+	/** Absolute rotation the kernel was selected for, the component does not notify when it changes */
+	bool bArmKernelAbsoluteRotation = false;
+	/** Collision test the kernel was selected for, changes with the arm evaluation */
+	bool bArmKernelCollisionTest = false;
+
+	TWeakObjectPtr<UCMCameraBudgetGovernor> QualityLevelGovernor;
+	FDelegateHandle QualityLevelChangedHandle;
+
 	/** Cached component-space socket location */
 	FVector RelativeSocketLocation = FVector::ZeroVector;
 	/** Cached component-space socket rotation */
 	FQuat RelativeSocketRotation = FQuat::Identity;
+
+	FVector AdditiveLocationOffset = FVector::ZeroVector;
+	FQuat AdditiveRotationOffset = FQuat::Identity;
+
+	bool bHasRotationTarget = false;
+	FRotator RotationTarget = FRotator::ZeroRotator;
+
+	bool bHasCameraOverride = false;
+	FTransform CameraOverride = FTransform::Identity;
 };
 